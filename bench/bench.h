@@ -0,0 +1,50 @@
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Helpers shared by the benchmark tools.
+ */
+namespace bench {
+
+/// @brief Splits @a list at every comma, skipping empty items.
+inline std::vector<std::string>
+split(const std::string& list)
+{
+  std::vector<std::string> result;
+  std::stringstream items(list);
+  std::string item;
+  while (std::getline(items, item, ','))
+    if (!item.empty())
+      result.push_back(item);
+  return result;
+}
+
+/**
+ * @brief Parses the comma-separated list of positive numbers @a list into
+ *   @a result.
+ * @return The first item that is not a positive number, or the empty string if
+ *   every item is.
+ */
+inline std::string
+parse_sizes(const std::string& list, std::vector<size_t>& result)
+{
+  std::vector<std::string> items = split(list);
+  for (size_t i = 0; i < items.size(); ++i)
+  {
+    std::istringstream item(items[i]);
+    size_t n = 0;
+    item >> n;
+    if (item.fail() or not item.eof() or n == 0)
+      return items[i];
+    result.push_back(n);
+  }
+  return std::string();
+}
+
+} // namespace bench
+
+#endif // __BENCH_H
@@ -0,0 +1,218 @@
+#ifndef __GENERATORS_H
+#define __GENERATORS_H
+
+#include "graph.h"
+#include "pg.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace graph {
+namespace pg {
+
+/**
+ * @brief Generators for the families of parity games used by the benchmarks.
+ *
+ * Every generator replaces the contents of a game with roughly @a n vertices,
+ * every vertex of which has at least one successor. Generators that use random
+ * numbers are deterministic for a given @a seed, so that results can be
+ * compared across builds.
+ */
+namespace generate {
+
+/// @brief Adds an edge from @a src to @a dst to @a game.
+template<typename graph_t>
+inline void
+edge(graph_t& game, VertexIndex src, VertexIndex dst)
+{
+  game.vertex(src).out.insert(dst);
+  game.vertex(dst).in.insert(src);
+}
+
+/// @brief Sets the priority and player of vertex @a v of @a game.
+template<typename graph_t>
+inline void
+label(graph_t& game, VertexIndex v, Priority prio, Player player)
+{
+  game.vertex(v).label.prio = prio;
+  game.vertex(v).label.player = player;
+}
+
+/**
+ * @brief Random game in which every vertex has between 1 and 2 * @a degree - 1
+ *   successors, and a priority below @a priorities.
+ */
+template<typename graph_t>
+void
+random(graph_t& game, size_t n, size_t degree, size_t priorities, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<size_t> target(0, n - 1);
+  std::uniform_int_distribution<size_t> outdegree(1, 2 * degree - 1);
+  std::uniform_int_distribution<size_t> prio(0, priorities - 1);
+  game.resize(0);
+  game.resize(n);
+  for (size_t v = 0; v < n; ++v)
+  {
+    label(game, v, prio(rng), (Player)(rng() % 2));
+    for (size_t d = outdegree(rng); d > 0; --d)
+      edge(game, v, target(rng));
+  }
+}
+
+/**
+ * @brief Ladder of @a n / 2 rungs.
+ *
+ * Vertex 2i belongs to even and vertex 2i + 1 to odd; both move to either vertex
+ * of the next rung, and the last rung leads back to the first. Priorities
+ * repeat every @a priorities rungs, so the game is a single SCC that the
+ * bisimulations reduce to @a priorities rungs.
+ */
+template<typename graph_t>
+void
+ladder(graph_t& game, size_t n, size_t priorities)
+{
+  size_t rungs = n / 2 ? n / 2 : 1;
+  game.resize(0);
+  game.resize(2 * rungs);
+  for (size_t r = 0; r < rungs; ++r)
+  {
+    size_t next = (r + 1) % rungs;
+    for (size_t side = 0; side < 2; ++side)
+    {
+      label(game, 2 * r + side, r % priorities, (Player)side);
+      edge(game, 2 * r + side, 2 * next);
+      edge(game, 2 * r + side, 2 * next + 1);
+    }
+  }
+}
+
+/**
+ * @brief Chain of cliques of @a k vertices each.
+ *
+ * Every vertex of a clique has an edge to every vertex of the same clique,
+ * itself included, and the first vertex of each clique has an edge to the first
+ * vertex of the next clique. The number of edges grows with @a k times @a n.
+ */
+template<typename graph_t>
+void
+cliques(graph_t& game, size_t n, size_t k, size_t priorities, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<size_t> prio(0, priorities - 1);
+  size_t count = n / k ? n / k : 1;
+  game.resize(0);
+  game.resize(count * k);
+  for (size_t c = 0; c < count; ++c)
+  {
+    size_t first = c * k;
+    for (size_t i = first; i < first + k; ++i)
+    {
+      label(game, i, prio(rng), (Player)(rng() % 2));
+      for (size_t j = first; j < first + k; ++j)
+        edge(game, i, j);
+    }
+    if (c + 1 < count)
+      edge(game, first, first + k);
+  }
+}
+
+/**
+ * @brief Long chain in which runs of @a stretch consecutive vertices have the
+ *   same priority and player.
+ *
+ * Vertex i moves to vertex i + 1, the last vertex loops to itself, and every
+ * vertex at the end of a run can also return to vertex 0. Stuttering
+ * equivalences collapse every run, bisimulation hardly reduces the chain.
+ */
+template<typename graph_t>
+void
+chain(graph_t& game, size_t n, size_t stretch, size_t priorities)
+{
+  game.resize(0);
+  game.resize(n);
+  for (size_t v = 0; v < n; ++v)
+  {
+    size_t run = v / stretch;
+    label(game, v, run % priorities, (Player)((run / priorities) % 2));
+    edge(game, v, v + 1 < n ? v + 1 : v);
+    if (v % stretch == stretch - 1)
+      edge(game, v, 0);
+  }
+}
+
+/**
+ * @brief Game consisting of cycles of @a k vertices that all have the same
+ *   priority and player, connected in a random acyclic fashion.
+ *
+ * The first vertex of every cycle has an edge to the first vertex of a randomly
+ * chosen later cycle, so the game has @a n / @a k non-trivial SCCs.
+ */
+template<typename graph_t>
+void
+sccs(graph_t& game, size_t n, size_t k, size_t priorities, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  size_t count = n / k ? n / k : 1;
+  game.resize(0);
+  game.resize(count * k);
+  for (size_t c = 0; c < count; ++c)
+  {
+    size_t first = c * k;
+    Player player = (Player)(rng() % 2);
+    Priority prio = rng() % priorities;
+    for (size_t i = 0; i < k; ++i)
+    {
+      label(game, first + i, prio, player);
+      edge(game, first + i, first + (i + 1) % k);
+    }
+    if (c + 1 < count)
+    {
+      std::uniform_int_distribution<size_t> later(c + 1, count - 1);
+      edge(game, first, later(rng) * k);
+    }
+  }
+}
+
+/// @brief Names of the families that make() accepts, separated by commas.
+inline const char*
+families()
+{
+  return "random,ladder,cliques,chain,sccs";
+}
+
+/**
+ * @brief Generates a game of family @a family with roughly @a n vertices.
+ *
+ * The shape parameters of every family are fixed, so that a family and a size
+ * determine the game: random games have average degree 3 and 8 priorities,
+ * cliques have 16 vertices, chains have runs of 32 vertices and SCCs have 8.
+ * @throws std::runtime_error if @a family is unknown.
+ */
+template<typename graph_t>
+void
+make(graph_t& game, const std::string& family, size_t n, unsigned seed)
+{
+  if (n == 0)
+    throw std::runtime_error("Generated games must have at least one vertex.");
+  if (family == "random")
+    random(game, n, 3, 8, seed);
+  else if (family == "ladder")
+    ladder(game, n, 4);
+  else if (family == "cliques")
+    cliques(game, n, 16, 4, seed);
+  else if (family == "chain")
+    chain(game, n, 32, 4);
+  else if (family == "sccs")
+    sccs(game, n, 8, 8, seed);
+  else
+    throw std::runtime_error("Unknown game family " + family + ".");
+}
+
+} // namespace generate
+} // namespace pg
+} // namespace graph
+
+#endif // __GENERATORS_H
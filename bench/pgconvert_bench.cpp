@@ -0,0 +1,190 @@
+#include "equivalence.h"
+#include "reducer.h"
+#include "batch.h"
+#include "streams.h"
+#include "generators.h"
+#include "bench.h"
+
+#include "cppcli/output_tool.h"
+#include "cpplogging/logger.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <iostream>
+
+/**
+ * @class pgconvert_bench
+ * @brief Tool class that times the parity game reductions on generated games.
+ */
+class pgconvert_bench : public tools::output_tool
+{
+  private:
+    typedef Reducer<Stopwatch>::game_t game_t;
+    std::vector<std::string> m_families; ///< The game families to generate.
+    std::vector<size_t> m_sizes; ///< The number of vertices of the generated games.
+    std::vector<Equivalence> m_equivalences; ///< The reductions to time.
+    size_t m_repeat; ///< The number of times every measurement is repeated.
+    unsigned m_seed; ///< Seed for the generators that use random numbers.
+    std::string m_label; ///< Written in the first column, to tell builds apart.
+    OutputFile m_output;
+
+    /**
+     * @brief Loads, reduces and saves @a text modulo @a e @a m_repeat times, and
+     *   writes the fastest time of every phase to @a s.
+     */
+    void
+    measure(const std::string& family, const game_t& generated,
+        const std::string& text, Equivalence e, std::ostream& s)
+    {
+      ReductionOptions options;
+      options.pipeline.push_back(e);
+      std::vector<std::string> phases;
+      std::map<std::string, double> best;
+      size_t nodes = 0, edges = 0;
+      for (size_t i = 0; i < m_repeat; ++i)
+      {
+        Stopwatch stopwatch;
+        Reducer<Stopwatch> reducer(stopwatch, options);
+        game_t game;
+        std::istringstream input(text);
+        reducer.load(game, input);
+        reducer.run(game);
+        std::ostringstream output;
+        reducer.save(game, output);
+        nodes = game.size();
+        edges = game.num_edges();
+        game.resize(0);
+        graph::memory::release();
+        const Stopwatch::timings_t& timings = stopwatch.timings();
+        for (size_t t = 0; t < timings.size(); ++t)
+        {
+          std::map<std::string, double>::iterator b = best.find(timings[t].first);
+          if (b == best.end())
+          {
+            phases.push_back(timings[t].first);
+            best[timings[t].first] = timings[t].second;
+          }
+          else
+            b->second = std::min(b->second, timings[t].second);
+        }
+      }
+      for (size_t p = 0; p < phases.size(); ++p)
+        s << m_label << '\t' << family << '\t' << generated.size() << '\t'
+          << generated.num_edges() << '\t' << e.name() << '\t' << nodes << '\t'
+          << edges << '\t' << phases[p] << '\t' << best[phases[p]] << '\n';
+      s << std::flush;
+    }
+  public:
+    pgconvert_bench() :
+  tools::output_tool(
+  // Tool name:
+      "pgconvert_bench",
+      // Author:
+      "S. Cranen",
+      // Tool summary:
+      "Times the parity game reductions on generated games.",
+      // Tool description:
+      "Generates parity games of several families and sizes, and loads, reduces "
+    "and saves each of them with every reduction of pgconvert. For every "
+    "phase, the fastest of a number of repetitions is written to OUTFILE as a "
+    "tab-separated line containing the label, the family, the number of nodes "
+    "and edges of the game, the reduction, the number of nodes and edges after "
+    "reduction, the phase and the time in seconds.",
+      // Known issues:
+      "None"),
+      m_repeat(3), m_seed(1), m_label("-")
+    {
+    }
+
+    /// @brief Runs the tool (see tools::output_tool::run).
+    bool
+    run()
+    {
+      std::ostream& s = m_output.open(m_output_filename);
+      s << "label\tfamily\tnodes\tedges\tequivalence\treduced_nodes\treduced_edges"
+           "\tphase\tseconds\n";
+      for (size_t f = 0; f < m_families.size(); ++f)
+        for (size_t n = 0; n < m_sizes.size(); ++n)
+        {
+          game_t generated;
+          graph::pg::generate::make(generated, m_families[f], m_sizes[n], m_seed);
+          cpplog(cpplogging::verbose)
+            << "Generated " << m_families[f] << " game with " << generated.size()
+            << " nodes and " << generated.num_edges() << " edges." << std::endl;
+          std::ostringstream text;
+          graph::Parser<game_t::vertex_t, graph::pgsolver> parser(generated);
+          parser.dump(text);
+          for (size_t e = 0; e < m_equivalences.size(); ++e)
+            measure(m_families[f], generated, text.str(), m_equivalences[e], s);
+        }
+      return true;
+    }
+  protected:
+    /// @brief Adds the benchmark options (see tools::output_tool::add_options).
+    void
+    add_options(interface_description& desc)
+    {
+      tools::output_tool::add_options(desc);
+      desc.add_option("families", make_mandatory_argument("NAME[,NAME]..."),
+    std::string("The game families to generate, chosen from ")
+    + graph::pg::generate::families() + " (default: all).");
+      desc.add_option("sizes", make_mandatory_argument("NUM[,NUM]..."),
+    "The number of nodes of the generated games (default 10000,100000).");
+      desc.add_option("equivalence", make_mandatory_argument("NAME[,NAME]..."),
+    "The reductions to time, as for pgconvert (default: all).", 'e');
+      desc.add_option("repeat", make_mandatory_argument("NUM"),
+    "Repeat every measurement NUM times and report the fastest (default 3).");
+      desc.add_option("seed", make_mandatory_argument("NUM"),
+    "Seed for the generators of random games (default 1).");
+      desc.add_option("label", make_mandatory_argument("NAME"),
+    "Write NAME in the first column, e.g. to tell the results of different "
+    "builds apart (default '-').");
+    }
+    /// @brief Parses the benchmark options (see tools::output_tool::parse_options).
+    void
+    parse_options(const command_line_parser& parser)
+    {
+      tools::output_tool::parse_options(parser);
+      m_families = bench::split(parser.options.count("families") ?
+          parser.option_argument("families") : graph::pg::generate::families());
+      std::vector<std::string> known = bench::split(graph::pg::generate::families());
+      for (size_t i = 0; i < m_families.size(); ++i)
+        if (std::find(known.begin(), known.end(), m_families[i]) == known.end())
+          parser.error("option --families has illegal argument '" + m_families[i] + "'");
+      std::string bad = bench::parse_sizes(parser.options.count("sizes") ?
+          parser.option_argument("sizes") : "10000,100000", m_sizes);
+      if (!bad.empty())
+        parser.error("option --sizes has illegal argument '" + bad + "'");
+      if (parser.options.count("equivalence"))
+      {
+        std::vector<std::string> names = bench::split(parser.option_argument("equivalence"));
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+          Equivalence e(names[i]);
+          if (e == Equivalence::invalid)
+            parser.error("option -e/--equivalence has illegal argument '" + names[i] + "'");
+          m_equivalences.push_back(e);
+        }
+      }
+      else
+        for (unsigned int i = 0; not Equivalence::name(i).empty(); ++i)
+          m_equivalences.push_back(Equivalence(Equivalence::name(i)));
+      if (parser.options.count("repeat"))
+      {
+        m_repeat = parser.option_argument_as<size_t>("repeat");
+        if (m_repeat == 0)
+          parser.error("option --repeat requires a positive number.");
+      }
+      if (parser.options.count("seed"))
+        m_seed = parser.option_argument_as<unsigned>("seed");
+      if (parser.options.count("label"))
+        m_label = parser.option_argument("label");
+    }
+};
+
+int
+main(int argc, char** argv)
+{
+  return std::auto_ptr<pgconvert_bench>(new pgconvert_bench())->execute(argc, argv);
+}
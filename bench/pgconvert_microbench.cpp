@@ -0,0 +1,473 @@
+// Count the nodes taken from the node pool as well (see Probe).
+#define GRAPH_POOL_STATISTICS
+
+#include "reducer.h"
+#include "streams.h"
+#include "generators.h"
+#include "bench.h"
+
+#include "cppcli/output_tool.h"
+#include "cpplogging/logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+
+/*
+ * Every allocation made by the benchmark goes through these operators or, for
+ * the nodes of sets and lists, through the node pool, so that a Probe can tell
+ * how many allocations a kernel makes.
+ */
+static std::atomic<size_t> allocations(0); ///< Number of calls to operator new.
+static std::atomic<size_t> allocated(0); ///< Number of bytes requested from operator new.
+
+/*
+ * Allocates @a size bytes with malloc and counts the allocation. The operators
+ * below are replaced as a set, so that every form of new and delete agrees on
+ * malloc and free.
+ */
+static void*
+counted_alloc(size_t size)
+{
+  ++allocations;
+  allocated += size;
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void*
+operator new(size_t size)
+{
+  return counted_alloc(size);
+}
+
+void*
+operator new[](size_t size)
+{
+  return counted_alloc(size);
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete[](void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+/**
+ * @class Probe
+ * @brief Measures the time and the allocations of a single call of a kernel.
+ * @details Nodes taken from the node pool count as allocations, and so do the
+ *   chunks the pool takes from operator new.
+ */
+class Probe
+{
+  public:
+    Probe() : seconds(0), allocations(0), bytes(0) {}
+    void start()
+    {
+      allocations = total_allocations();
+      bytes = total_allocated();
+      m_start = std::chrono::steady_clock::now();
+    }
+    void stop()
+    {
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_start;
+      seconds = elapsed.count();
+      allocations = total_allocations() - allocations;
+      bytes = total_allocated() - bytes;
+    }
+    double seconds;
+    size_t allocations;
+    size_t bytes;
+  private:
+    std::chrono::steady_clock::time_point m_start;
+
+    static size_t
+    total_allocations()
+    {
+      return ::allocations + graph::impl::NodePool::instance().allocations();
+    }
+    static size_t
+    total_allocated()
+    {
+      return ::allocated + graph::impl::NodePool::instance().allocated();
+    }
+};
+
+/**
+ * @class Fixture
+ * @brief Gives the benchmarks access to the steps of a partitioner.
+ */
+template<typename Partitioner>
+class Fixture : public Partitioner
+{
+  public:
+    typedef typename Partitioner::graph_t graph_t;
+    typedef typename Partitioner::block_t block_t;
+    using Partitioner::refine;
+
+    Fixture(const graph_t& graph) : Partitioner(graph) {}
+
+    /// @brief Creates the initial partition, as partition() does before refining.
+    void
+    initial_partition()
+    {
+      this->m_state.resize(this->m_pg.size());
+      this->create_initial_partition();
+    }
+
+    /// @brief Calls update() on every block.
+    void
+    update()
+    {
+      for (typename Partitioner::blocklist_t::iterator B = this->m_blocks.begin();
+          B != this->m_blocks.end(); ++B)
+        B->update();
+    }
+
+    /// @brief Returns the block with the most vertices.
+    block_t&
+    largest()
+    {
+      typename Partitioner::blocklist_t::iterator result = this->m_blocks.begin();
+      size_t most = 0;
+      for (typename Partitioner::blocklist_t::iterator B = this->m_blocks.begin();
+          B != this->m_blocks.end(); ++B)
+      {
+        size_t size = std::distance(B->vertices.begin(), B->vertices.end());
+        if (size > most)
+        {
+          most = size;
+          result = B;
+        }
+      }
+      return *result;
+    }
+
+    /// @brief Marks every other vertex of @a B, so that refine() moves it to a new block.
+    void
+    mark_half(const block_t& B)
+    {
+      bool mark = false;
+      for (graph::VertexList::const_iterator v = B.vertices.begin(); v != B.vertices.end(); ++v)
+        this->m_state.pos[*v] = mark = !mark;
+    }
+};
+
+/**
+ * @class AttractorFixture
+ * @brief Gives the benchmarks access to the attractor computation of the
+ *   governed stuttering partitioner.
+ */
+template<typename Label>
+class AttractorFixture : public Fixture<graph::pg::GovernedStutteringPartitioner<Label> >
+{
+  public:
+    typedef Fixture<graph::pg::GovernedStutteringPartitioner<Label> > base;
+    typedef typename base::block_t block_t;
+    using base::attractor;
+
+    AttractorFixture(const typename base::graph_t& graph) : base(graph) {}
+
+    /**
+     * @brief Stores in @a todo the vertices of @a B from which @a p can leave @a B,
+     *   as split() does before it computes the attractor of these vertices.
+     */
+    void
+    prepare(const block_t& B, graph::pg::Player p, graph::VertexList& todo)
+    {
+      for (graph::VertexList::const_iterator v = B.vertices.begin(); v != B.vertices.end(); ++v)
+      {
+        this->m_state.visitcounter[*v] = this->m_state.external[*v];
+        if (this->m_state.visitcounter[*v] == this->m_pg.vertex(*v).out.size() or
+            (this->m_pg.vertex(*v).label.player == p and this->m_state.visited(*v)))
+          todo.push_front(*v);
+      }
+    }
+};
+
+/**
+ * @class pgconvert_microbench
+ * @brief Tool class that times the building blocks of the reductions in isolation.
+ */
+class pgconvert_microbench : public tools::output_tool
+{
+  private:
+    typedef graph::pg::DivLabel label_t;
+    typedef graph::KripkeStructure<graph::Vertex<label_t> > game_t;
+    typedef std::function<void(const game_t&, Probe&)> kernel_t;
+    std::vector<std::pair<std::string, kernel_t> > m_kernels; ///< The kernels that are timed.
+    std::vector<std::string> m_families; ///< The game families to generate.
+    std::vector<size_t> m_sizes; ///< The number of vertices of the generated games.
+    size_t m_repeat; ///< The number of times every measurement is repeated.
+    unsigned m_seed; ///< Seed for the generators that use random numbers.
+    std::string m_label; ///< Written in the first column, to tell builds apart.
+    OutputFile m_output;
+
+    /// @brief Returns a copy of @a game in which every SCC has been collapsed.
+    static game_t
+    collapsed(const game_t& game)
+    {
+      game_t result = game;
+      result.collapse_sccs();
+      return result;
+    }
+
+    template<typename Partitioner>
+    static void
+    update(const game_t& game, Probe& probe)
+    {
+      Fixture<Partitioner> p(game);
+      p.initial_partition();
+      probe.start();
+      p.update();
+      probe.stop();
+    }
+
+    template<typename Partitioner>
+    static void
+    refine(const game_t& game, Probe& probe)
+    {
+      Fixture<Partitioner> p(game);
+      p.initial_partition();
+      typename Fixture<Partitioner>::block_t& B = p.largest();
+      p.mark_half(B);
+      probe.start();
+      p.refine(B);
+      probe.stop();
+    }
+
+    template<typename Partitioner>
+    static void
+    quotient(const game_t& game, Probe& probe)
+    {
+      Partitioner p(game);
+      game_t result;
+      p.partition();
+      probe.start();
+      p.store_quotient(result);
+      probe.stop();
+    }
+
+    static void
+    attractor(const game_t& game, Probe& probe)
+    {
+      AttractorFixture<label_t> p(game);
+      p.initial_partition();
+      const AttractorFixture<label_t>::block_t& B = p.largest();
+      graph::VertexList todo;
+      p.prepare(B, graph::pg::even, todo);
+      probe.start();
+      p.attractor(&B, graph::pg::even, todo);
+      probe.stop();
+    }
+
+    /// @brief Registers every kernel under its name.
+    void
+    add_kernels()
+    {
+      typedef graph::BisimulationPartitioner<label_t> bisim_t;
+      typedef graph::pg::FMIBPartitioner<label_t> fmib_t;
+      typedef graph::StutteringPartitioner<label_t> stut_t;
+      typedef graph::pg::GovernedStutteringPartitioner<label_t> gstut_t;
+      typedef graph::pg::ParadisePartitioner<label_t> paradise_t;
+      m_kernels.push_back(std::make_pair("tarjan", [](const game_t& game, Probe& probe)
+      {
+        std::vector<graph::VertexIndex> scc(game.size());
+        probe.start();
+        graph::impl::tarjan_iterative(game.vertices(), scc);
+        probe.stop();
+      }));
+      m_kernels.push_back(std::make_pair("collapse", [](const game_t& game, Probe& probe)
+      {
+        game_t::vertices_t vertices = game.vertices();
+        std::vector<graph::VertexIndex> scc(vertices.size());
+        graph::impl::tarjan_iterative(vertices, scc);
+        probe.start();
+        graph::impl::collapse(vertices, scc);
+        probe.stop();
+      }));
+      m_kernels.push_back(std::make_pair("update/bisim", kernel_t(update<bisim_t>)));
+      m_kernels.push_back(std::make_pair("update/fmib", kernel_t(update<fmib_t>)));
+      m_kernels.push_back(std::make_pair("update/stut", [](const game_t& game, Probe& probe)
+      {
+        update<stut_t>(collapsed(game), probe);
+      }));
+      m_kernels.push_back(std::make_pair("update/gstut", kernel_t(update<gstut_t>)));
+      m_kernels.push_back(std::make_pair("refine/bisim", kernel_t(refine<bisim_t>)));
+      m_kernels.push_back(std::make_pair("refine/gstut", kernel_t(refine<gstut_t>)));
+      m_kernels.push_back(std::make_pair("attractor/gstut", kernel_t(attractor)));
+      m_kernels.push_back(std::make_pair("quotient/bisim", kernel_t(quotient<bisim_t>)));
+      m_kernels.push_back(std::make_pair("quotient/fmib", kernel_t(quotient<fmib_t>)));
+      m_kernels.push_back(std::make_pair("quotient/stut", [](const game_t& game, Probe& probe)
+      {
+        quotient<stut_t>(collapsed(game), probe);
+      }));
+      m_kernels.push_back(std::make_pair("quotient/gstut", kernel_t(quotient<gstut_t>)));
+      m_kernels.push_back(std::make_pair("quotient/paradise", kernel_t(quotient<paradise_t>)));
+    }
+
+    /**
+     * @brief Runs @a kernel on @a game @a m_repeat times, and writes the fastest
+     *   time and the resulting throughput and allocations to @a s.
+     */
+    void
+    measure(const std::string& family, const game_t& game,
+        const std::pair<std::string, kernel_t>& kernel, std::ostream& s)
+    {
+      Probe best;
+      for (size_t i = 0; i < m_repeat; ++i)
+      {
+        Probe probe;
+        kernel.second(game, probe);
+        if (i == 0 or probe.seconds < best.seconds)
+          best = probe;
+      }
+      size_t edges = game.num_edges();
+      s << m_label << '\t' << kernel.first << '\t' << family << '\t' << game.size()
+        << '\t' << edges << '\t' << best.seconds << '\t'
+        << (best.seconds > 0 ? edges / best.seconds : 0) << '\t' << best.allocations
+        << '\t' << best.bytes << '\n' << std::flush;
+    }
+  public:
+    pgconvert_microbench() :
+  tools::output_tool(
+  // Tool name:
+      "pgconvert_microbench",
+      // Author:
+      "S. Cranen",
+      // Tool summary:
+      "Times the building blocks of the parity game reductions.",
+      // Tool description:
+      "Generates parity games of several families and sizes, and times SCC "
+    "decomposition, SCC collapsing, and the block updates, refinement step, "
+    "attractor computation and quotienting of the partitioners on each of "
+    "them. For every kernel and game, a tab-separated line is written to "
+    "OUTFILE containing the label, the kernel, the family, the number of nodes "
+    "and edges of the game, the fastest of a number of repetitions in seconds, "
+    "the number of edges per second, and the number of allocations and bytes "
+    "allocated by one call of the kernel. The kernels of the stuttering "
+    "partitioner run on the game after collapsing its SCCs.",
+      // Known issues:
+      "None"),
+      m_repeat(3), m_seed(1), m_label("-")
+    {
+      add_kernels();
+    }
+
+    /// @brief Runs the tool (see tools::output_tool::run).
+    bool
+    run()
+    {
+      std::ostream& s = m_output.open(m_output_filename);
+      s << "label\tkernel\tfamily\tnodes\tedges\tseconds\tedges_per_second"
+           "\tallocations\tbytes\n";
+      for (size_t f = 0; f < m_families.size(); ++f)
+        for (size_t n = 0; n < m_sizes.size(); ++n)
+        {
+          game_t game;
+          graph::pg::generate::make(game, m_families[f], m_sizes[n], m_seed);
+          cpplog(cpplogging::verbose)
+            << "Generated " << m_families[f] << " game with " << game.size()
+            << " nodes and " << game.num_edges() << " edges." << std::endl;
+          for (size_t k = 0; k < m_kernels.size(); ++k)
+            measure(m_families[f], game, m_kernels[k], s);
+        }
+      return true;
+    }
+  protected:
+    /// @brief Adds the benchmark options (see tools::output_tool::add_options).
+    void
+    add_options(interface_description& desc)
+    {
+      tools::output_tool::add_options(desc);
+      std::string kernels;
+      for (size_t k = 0; k < m_kernels.size(); ++k)
+        kernels += (k ? "," : "") + m_kernels[k].first;
+      desc.add_option("kernels", make_mandatory_argument("NAME[,NAME]..."),
+    "The kernels to time, chosen from " + kernels + " (default: all).");
+      desc.add_option("families", make_mandatory_argument("NAME[,NAME]..."),
+    std::string("The game families to generate, chosen from ")
+    + graph::pg::generate::families() + " (default: all).");
+      desc.add_option("sizes", make_mandatory_argument("NUM[,NUM]..."),
+    "The number of nodes of the generated games (default 1000,10000,100000).");
+      desc.add_option("repeat", make_mandatory_argument("NUM"),
+    "Repeat every measurement NUM times and report the fastest (default 3).");
+      desc.add_option("seed", make_mandatory_argument("NUM"),
+    "Seed for the generators of random games (default 1).");
+      desc.add_option("label", make_mandatory_argument("NAME"),
+    "Write NAME in the first column, e.g. to tell the results of different "
+    "builds apart (default '-').");
+    }
+    /// @brief Parses the benchmark options (see tools::output_tool::parse_options).
+    void
+    parse_options(const command_line_parser& parser)
+    {
+      tools::output_tool::parse_options(parser);
+      if (parser.options.count("kernels"))
+      {
+        std::vector<std::string> names = bench::split(parser.option_argument("kernels"));
+        std::vector<std::pair<std::string, kernel_t> > kernels;
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+          size_t k = 0;
+          while (k < m_kernels.size() and m_kernels[k].first != names[i])
+            ++k;
+          if (k == m_kernels.size())
+            parser.error("option --kernels has illegal argument '" + names[i] + "'");
+          kernels.push_back(m_kernels[k]);
+        }
+        m_kernels.swap(kernels);
+      }
+      m_families = bench::split(parser.options.count("families") ?
+          parser.option_argument("families") : graph::pg::generate::families());
+      std::vector<std::string> known = bench::split(graph::pg::generate::families());
+      for (size_t i = 0; i < m_families.size(); ++i)
+        if (std::find(known.begin(), known.end(), m_families[i]) == known.end())
+          parser.error("option --families has illegal argument '" + m_families[i] + "'");
+      std::string bad = bench::parse_sizes(parser.options.count("sizes") ?
+          parser.option_argument("sizes") : "1000,10000,100000", m_sizes);
+      if (!bad.empty())
+        parser.error("option --sizes has illegal argument '" + bad + "'");
+      if (parser.options.count("repeat"))
+      {
+        m_repeat = parser.option_argument_as<size_t>("repeat");
+        if (m_repeat == 0)
+          parser.error("option --repeat requires a positive number.");
+      }
+      if (parser.options.count("seed"))
+        m_seed = parser.option_argument_as<unsigned>("seed");
+      if (parser.options.count("label"))
+        m_label = parser.option_argument("label");
+    }
+};
+
+int
+main(int argc, char** argv)
+{
+  return std::unique_ptr<pgconvert_microbench>(new pgconvert_microbench())->execute(argc, argv);
+}
@@ -12,13 +12,15 @@ class BisimulationTraits
 public:
   struct block_t;
 
-  typedef graph::PartitionerTraits::vertex_t<block_t, Label> vertex_t;
+  typedef graph::Vertex<Label> vertex_t;
   typedef graph::KripkeStructure<vertex_t> graph_t;
+  typedef PartitionerTraits::state_t<block_t> state_t;
   typedef VertexList vertexlist_t;
 
   struct block_t : public PartitionerTraits::block_t
   {
-    block_t(graph_t& pg, size_t index) : PartitionerTraits::block_t(index), pg(pg) {}
+    block_t(const graph_t& pg, state_t& state, size_t index) :
+      PartitionerTraits::block_t(index), pg(pg), state(state) {}
     bool update(PartitionerTraits::block_t* has_edge_from=NULL)
     {
       bool result = false;
@@ -26,16 +28,18 @@ public:
       incoming.clear();
       for (VertexList::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
       {
-        vertex_t& v = pg.vertex(*i);
+        const vertex_t& v = pg.vertex(*i);
+        state.statistics.update_edges += v.in.size();
         for (VertexSet::const_iterator src = v.in.begin(); src != v.in.end(); ++src)
         {
           incoming.push_front(*src);
-          result = result || (pg.vertex(*src).block == has_edge_from);
+          result = result || (state.block[*src] == has_edge_from);
         }
       }
       return result;
     }
-    graph_t& pg; ///< The partition(er) to which the block belongs.
+    const graph_t& pg; ///< The graph that is being partitioned.
+    state_t& state; ///< The per-vertex state of the partitioner.
   };
 
   typedef std::list<block_t> blocklist_t;
@@ -56,9 +60,10 @@ public:
   typedef typename base_t::blocklist_t blocklist_t;
   using base_t::m_blocks;
   using base_t::m_pg;
-  BisimulationPartitioner(graph_t& pg) : base_t(pg) {}
+  using base_t::m_state;
+  BisimulationPartitioner(const graph_t& pg) : base_t(pg) {}
   const blocklist_t blocks() const { return m_blocks; }
-  block_t& newblock() { m_blocks.push_back(block_t(m_pg, m_blocks.size())); return m_blocks.back(); }
+  block_t& newblock() { m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size())); return m_blocks.back(); }
 protected:
   /**
    * @brief Creates the initial partition.
@@ -73,14 +78,14 @@ protected:
     // Assign blocks to vertices
     for (size_t i = m_pg.size() - 1; i != (size_t)-1; --i)
     {
-      vertex_t& v = m_pg.vertex(i);
+      const vertex_t& v = m_pg.vertex(i);
       typename pmap::iterator B = blocks.find(v.label);
       if (B == blocks.end())
       {
-        m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+        m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
         B = blocks.insert(std::make_pair(v.label, &m_blocks.back())).first;
       }
-      v.block = B->second;
+      m_state.block[i] = B->second;
       B->second->vertices.push_front(i);
     }
 
@@ -100,22 +105,18 @@ protected:
     for (VertexList::const_iterator src = B->incoming.begin();
         src != B->incoming.end(); ++src)
     {
-      vertex_t& v = m_pg.vertex(*src);
-      v.visit();
-      v.block->visited = false;
+      m_state.visit(*src);
+      m_state.block[*src]->visited = false;
     }
 
     bool result = split(B, B);
 
     for (VertexList::const_iterator src = B->incoming.begin();
         src != B->incoming.end(); ++src)
-    {
-      vertex_t& v = m_pg.vertex(*src);
-      v.clear();
-    }
+      m_state.clear(*src);
     if(result)
         {
-          cpplog(cpplogging::debug) << "Block " << B->index << " is a self-splitter" << std::endl;
+          graphlog(cpplogging::debug) << "Block " << B->index << " is a self-splitter" << std::endl;
         }
     return result;
   }
@@ -130,56 +131,30 @@ protected:
     bool all_states_visited = true, no_states_visited = true;
     for (VertexList::const_iterator v = B1->vertices.begin(); v != B1->vertices.end(); ++v)
     {
-      vertex_t& vertex = m_pg.vertex(*v);
-      if (vertex.visited())
+      if (m_state.visited(*v))
       {
         no_states_visited = false;
-        vertex.pos = true;
+        m_state.pos[*v] = true;
       } else
         all_states_visited = false;
     }
     if (all_states_visited)
       for (VertexList::const_iterator v = B1->vertices.begin(); v != B1->vertices.end(); ++v)
-        m_pg.vertex(*v).pos = false;
+        m_state.pos[*v] = false;
     return !(all_states_visited || no_states_visited);
   }
   /**
-   * @brief Quotients the parity game and stores the result in @a g.
+   * @brief Labels the vertex that represents @a B in the quotient (see
+   *   Partitioner::describe).
    *
    * Quotienting is done by viewing each block as a vertex. The priority and player of a
    * block are defined as the priority and player of the first vertex in the block's
    * @c vertices member.
-   * @param quotient ParityGame in which the quotient is stored.
    */
-  void quotient(graph_t& quotient)
+  int describe(const block_t& B, typename vertex_t::label_t& label)
   {
-    quotient.resize(m_blocks.size());
-    size_t src, dst, vc = 1;
-
-    // Make sure node 0 is in block 0
-    size_t oldblock = m_pg.vertex(0).block->index;
-    m_pg.vertex(0).block->index = 0;
-    m_blocks.front().index = oldblock;
-
-    for (typename blocklist_t::const_iterator B = m_blocks.begin(); B != m_blocks.end(); ++B, ++vc)
-    {
-      dst = B->index;
-      VertexList::const_iterator v = B->vertices.begin();
-      vertex_t& repr = quotient.vertex(dst);
-      repr.label = m_pg.vertex(*v).label;
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv != B->incoming.end(); ++sv)
-        m_pg.vertex(m_pg.vertex(*sv).block->index).clear();
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv != B->incoming.end(); ++sv)
-      {
-        src = m_pg.vertex(*sv).block->index;
-        if (!m_pg.vertex(src).visited())
-        {
-          quotient.vertex(src).out.insert(dst);
-          repr.in.insert(src);
-          m_pg.vertex(src).visit();
-        }
-      }
-    }
+    label = m_pg.vertex(B.vertices.front()).label;
+    return this->no_self_loop;
   }
 };
 
@@ -0,0 +1,234 @@
+#ifndef __GRAPH_IMPL_ORDER_H
+#define __GRAPH_IMPL_ORDER_H
+
+#include "vertex.h"
+#include "detail/reach.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/**
+ * @brief Orders in which the vertices of a graph can be renumbered.
+ */
+enum VertexOrder
+{
+  original_order, ///< Keep the numbering of the input.
+  bfs_order, ///< Breadth-first search order, following outgoing edges.
+  rcm_order, ///< Reverse Cuthill-McKee order, ignoring edge directions.
+  scc_order ///< Strongly connected components in topological order.
+};
+
+namespace impl {
+
+/*
+ * Moves the vertex at position index[0] to position 0, and every vertex before
+ * it one position up, so that vertex 0 keeps its index.
+ */
+inline void
+first_vertex_first(std::vector<VertexIndex>& index)
+{
+  if (index.empty())
+    return;
+  VertexIndex first = index[0];
+  for (size_t i = 0; i < index.size(); ++i)
+    if (index[i] < first)
+      ++index[i];
+  index[0] = 0;
+}
+
+/*
+ * Sets index[v] to the position of v in a breadth-first search from vertex 0.
+ * Vertices that are not reachable from vertex 0 follow, in breadth-first order
+ * from the first vertex that has not been numbered yet.
+ */
+template <typename Vertex>
+void order_bfs(const std::vector<Vertex>& vertices, std::vector<VertexIndex>& index)
+{
+  index.assign(vertices.size(), removed);
+  std::vector<VertexIndex> queue;
+  queue.reserve(vertices.size());
+  size_t head = 0;
+  for (size_t root = 0; root < vertices.size(); ++root)
+  {
+    if (index[root] != removed)
+      continue;
+    index[root] = queue.size();
+    queue.push_back(root);
+    for (; head < queue.size(); ++head)
+    {
+      const Vertex& v = vertices[queue[head]];
+      for (graph::VertexSet::const_iterator w = v.out.begin(); w != v.out.end(); ++w)
+      {
+        if (index[*w] == removed)
+        {
+          index[*w] = queue.size();
+          queue.push_back(*w);
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Sets index[v] to the position of v in the reverse Cuthill-McKee order of the
+ * graph without edge directions, which keeps the neighbours of a vertex close
+ * to it. The search starts at vertex 0, and at a vertex of minimal degree for
+ * every further component; the neighbours of a vertex are visited in order of
+ * increasing degree. Vertex 0 is then moved to the front.
+ */
+template <typename Vertex>
+void order_rcm(const std::vector<Vertex>& vertices, std::vector<VertexIndex>& index)
+{
+  size_t n = vertices.size();
+  std::vector<size_t> degree(n);
+  std::vector<VertexIndex> by_degree(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    degree[i] = vertices[i].out.size() + vertices[i].in.size();
+    by_degree[i] = i;
+  }
+  std::stable_sort(by_degree.begin(), by_degree.end(),
+      [&degree](VertexIndex a, VertexIndex b) { return degree[a] < degree[b]; });
+  auto lower_degree = [&degree](VertexIndex a, VertexIndex b)
+  {
+    return degree[a] < degree[b] or (degree[a] == degree[b] and a < b);
+  };
+
+  std::vector<char> seen(n, false);
+  std::vector<VertexIndex> order;
+  order.reserve(n);
+  size_t head = 0, next_root = 0;
+  for (size_t c = 0; order.size() < n; ++c)
+  {
+    VertexIndex root = 0;
+    if (c > 0)
+    {
+      while (seen[by_degree[next_root]])
+        ++next_root;
+      root = by_degree[next_root];
+    }
+    seen[root] = true;
+    order.push_back(root);
+    for (; head < order.size(); ++head)
+    {
+      const Vertex& v = vertices[order[head]];
+      size_t first = order.size();
+      for (graph::VertexSet::const_iterator w = v.out.begin(); w != v.out.end(); ++w)
+        if (not seen[*w])
+        {
+          seen[*w] = true;
+          order.push_back(*w);
+        }
+      for (graph::VertexSet::const_iterator w = v.in.begin(); w != v.in.end(); ++w)
+        if (not seen[*w])
+        {
+          seen[*w] = true;
+          order.push_back(*w);
+        }
+      std::sort(order.begin() + first, order.end(), lower_degree);
+    }
+  }
+  index.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    index[order[i]] = n - 1 - i;
+  first_vertex_first(index);
+}
+
+/*
+ * Sets index[v] such that the strongly connected components of the graph are
+ * numbered consecutively and in topological order, so that edges between
+ * components lead to higher indices. Vertex 0 is then moved to the front.
+ *
+ * Unlike tarjan_iterative, this considers all edges, regardless of labels.
+ */
+template <typename Vertex>
+void order_scc(const std::vector<Vertex>& vertices, std::vector<VertexIndex>& index)
+{
+  typedef std::pair<VertexIndex, graph::VertexSet::const_iterator> frame_t;
+  size_t n = vertices.size();
+  std::vector<VertexIndex> number(n, 0), low(n, 0);
+  std::vector<char> on_stack(n, false);
+  std::vector<VertexIndex> sccstack, order;
+  std::vector<frame_t> callstack;
+  order.reserve(n);
+  VertexIndex unused = 1;
+  for (size_t root = 0; root < n; ++root)
+  {
+    if (number[root] != 0)
+      continue;
+    number[root] = low[root] = unused++;
+    on_stack[root] = true;
+    sccstack.push_back(root);
+    callstack.push_back(frame_t(root, vertices[root].out.begin()));
+    while (not callstack.empty())
+    {
+      VertexIndex v = callstack.back().first;
+      if (callstack.back().second != vertices[v].out.end())
+      {
+        VertexIndex w = *callstack.back().second++;
+        if (number[w] == 0)
+        {
+          number[w] = low[w] = unused++;
+          on_stack[w] = true;
+          sccstack.push_back(w);
+          callstack.push_back(frame_t(w, vertices[w].out.begin()));
+        }
+        else if (on_stack[w] and number[w] < low[v])
+          low[v] = number[w];
+        continue;
+      }
+      callstack.pop_back();
+      if (not callstack.empty())
+      {
+        VertexIndex u = callstack.back().first;
+        if (low[v] < low[u])
+          low[u] = low[v];
+      }
+      if (low[v] == number[v])
+      {
+        VertexIndex w;
+        do
+        {
+          w = sccstack.back();
+          sccstack.pop_back();
+          on_stack[w] = false;
+          order.push_back(w);
+        }
+        while (w != v);
+      }
+    }
+  }
+  // Components are completed in reverse topological order.
+  index.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    index[order[i]] = n - 1 - i;
+  first_vertex_first(index);
+}
+
+/*
+ * Sets index[v] to the position of v in the given order; the result can be
+ * passed to renumber.
+ */
+template <typename Vertex>
+void order(const std::vector<Vertex>& vertices, VertexOrder how, std::vector<VertexIndex>& index)
+{
+  if (how == bfs_order)
+    order_bfs(vertices, index);
+  else if (how == rcm_order)
+    order_rcm(vertices, index);
+  else if (how == scc_order)
+    order_scc(vertices, index);
+  else
+  {
+    index.resize(vertices.size());
+    for (size_t i = 0; i < index.size(); ++i)
+      index[i] = i;
+  }
+}
+
+} // namespace impl
+} // namespace graph
+
+#endif // __GRAPH_IMPL_ORDER_H
@@ -0,0 +1,90 @@
+#ifndef __GRAPH_IMPL_PARALLEL_H
+#define __GRAPH_IMPL_PARALLEL_H
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "trace.h"
+
+namespace graph {
+namespace impl {
+
+/*
+ * Calls f(i) for every i in [0, count), using at most @a threads threads.
+ *
+ * Indices are handed out one at a time, which suits a small number of jobs of
+ * very different size (e.g. one job per input file). If any call throws, the
+ * remaining indices are skipped and the first exception is rethrown in the
+ * calling thread once all threads have finished.
+ */
+template <typename Function>
+void parallel_for_each(size_t count, size_t threads, Function f)
+{
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto worker = [&]()
+  {
+    for (size_t i = next++; i < count; i = next++)
+    {
+      try
+      {
+        trace::span job("parallel job");
+        f(i);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+          error = std::current_exception();
+        next = count;
+      }
+    }
+  };
+  if (threads > count)
+    threads = count;
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; ++t)
+    pool.push_back(std::thread(worker));
+  worker();
+  for (size_t t = 0; t < pool.size(); ++t)
+    pool[t].join();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+/*
+ * Calls f(begin, end) for consecutive ranges that together cover [0, count),
+ * using at most @a threads threads.
+ *
+ * The range is split in equally sized parts, one per thread, which suits loops
+ * in which every index takes roughly the same amount of work. No threads are
+ * started when @a threads is 1 or @a count is smaller than @a grain.
+ */
+template <typename Function>
+void parallel_for(size_t count, size_t threads, Function f, size_t grain = 4096)
+{
+  if (threads > count / grain)
+    threads = count / grain;
+  if (threads <= 1)
+  {
+    f((size_t)0, count);
+    return;
+  }
+  size_t chunk = (count + threads - 1) / threads;
+  parallel_for_each(threads, threads, [&](size_t t)
+  {
+    size_t begin = t * chunk;
+    size_t end = begin + chunk < count ? begin + chunk : count;
+    if (begin < end)
+      f(begin, end);
+  });
+}
+
+} // namespace impl
+} // namespace graph
+
+#endif // __GRAPH_IMPL_PARALLEL_H
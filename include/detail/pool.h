@@ -0,0 +1,175 @@
+#ifndef __GRAPH_IMPL_POOL_H
+#define __GRAPH_IMPL_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace graph {
+namespace impl {
+
+/*
+ * Pool for the small, fixed-size nodes of adjacency sets and vertex lists.
+ *
+ * Nodes are carved from chunks of 64 KiB, and freed nodes are kept on a free
+ * list per size class and per thread, so neither allocating nor freeing a node
+ * calls the global allocator, and tearing down a large graph no longer costs a
+ * call to free() per edge. Nodes may be freed by another thread than the one
+ * that allocated them; they then go to the free list of the freeing thread.
+ *
+ * The chunks are only returned to the global allocator by release(), once no
+ * node is in use any more. Sizes are rounded up to a multiple of 8 bytes, so
+ * nodes are aligned to 8 bytes.
+ *
+ * If GRAPH_POOL_STATISTICS is defined, the pool also counts the nodes it hands
+ * out and the bytes requested for them (see allocations()), for benchmarks.
+ */
+class NodePool
+{
+  public:
+    static const size_t granularity = 8;
+    static const size_t max_size = 64; ///< Larger requests do not use the pool.
+    static const size_t chunk_size = 1 << 16;
+
+    static NodePool&
+    instance()
+    {
+      static NodePool pool;
+      return pool;
+    }
+
+    void*
+    allocate(size_t size)
+    {
+      size_t c = (size + granularity - 1) / granularity - 1;
+      list_t& list = local(c);
+      m_live.fetch_add(1, std::memory_order_relaxed);
+#ifdef GRAPH_POOL_STATISTICS
+      m_allocations.fetch_add(1, std::memory_order_relaxed);
+      m_allocated.fetch_add(size, std::memory_order_relaxed);
+#endif
+      if (list.head != NULL)
+      {
+        void* result = list.head;
+        list.head = *static_cast<void**>(result);
+        return result;
+      }
+      size_t rounded = (c + 1) * granularity;
+      if (list.bump == NULL or list.bump + rounded > list.end)
+      {
+        list.bump = static_cast<char*>(chunk());
+        list.end = list.bump + chunk_size;
+      }
+      void* result = list.bump;
+      list.bump += rounded;
+      return result;
+    }
+
+    void
+    deallocate(void* p, size_t size)
+    {
+      size_t c = (size + granularity - 1) / granularity - 1;
+      list_t& list = local(c);
+      *static_cast<void**>(p) = list.head;
+      list.head = p;
+      m_live.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /*
+     * Returns all chunks to the global allocator if no node is in use, and
+     * returns whether it did. Must not be called while other threads allocate.
+     */
+    bool
+    release()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_live.load() != 0)
+        return false;
+      for (size_t i = 0; i < m_chunks.size(); ++i)
+        ::operator delete(m_chunks[i]);
+      m_chunks.clear();
+      ++m_epoch;
+      return true;
+    }
+
+    /// Returns the number of bytes held in chunks.
+    size_t
+    reserved()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_chunks.size() * chunk_size;
+    }
+
+#ifdef GRAPH_POOL_STATISTICS
+    /// Returns the number of nodes handed out so far.
+    size_t
+    allocations() const
+    {
+      return m_allocations.load();
+    }
+
+    /// Returns the number of bytes requested for the nodes handed out so far.
+    size_t
+    allocated() const
+    {
+      return m_allocated.load();
+    }
+#endif
+
+  private:
+    static const size_t classes = max_size / granularity;
+
+    struct list_t
+    {
+      list_t() : head(NULL), bump(NULL), end(NULL), epoch(0) {}
+      void* head; // Free list.
+      char* bump; // Next unused byte of the current chunk.
+      char* end; // End of the current chunk.
+      size_t epoch; // Value of m_epoch when the list was last used.
+    };
+
+    std::mutex m_mutex; // Protects m_chunks.
+    std::vector<void*> m_chunks;
+    std::atomic<size_t> m_epoch;
+    std::atomic<long long> m_live; // Nodes in use.
+#ifdef GRAPH_POOL_STATISTICS
+    std::atomic<size_t> m_allocations; // Nodes handed out.
+    std::atomic<size_t> m_allocated; // Bytes requested for them.
+
+    NodePool() : m_epoch(1), m_live(0), m_allocations(0), m_allocated(0) {}
+#else
+    NodePool() : m_epoch(1), m_live(0) {}
+#endif
+
+    // Returns the list of size class c of the calling thread; lists that refer to
+    // chunks freed by release() are emptied first.
+    list_t&
+    local(size_t c)
+    {
+      static thread_local list_t lists[classes];
+      list_t& list = lists[c];
+      size_t epoch = m_epoch.load(std::memory_order_relaxed);
+      if (list.epoch != epoch)
+      {
+        list = list_t();
+        list.epoch = epoch;
+      }
+      return list;
+    }
+
+    void*
+    chunk()
+    {
+      void* result = ::operator new(chunk_size);
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_chunks.push_back(result);
+      return result;
+    }
+};
+
+} // namespace impl
+} // namespace graph
+
+#endif // __GRAPH_IMPL_POOL_H
@@ -0,0 +1,103 @@
+#ifndef __GRAPH_IMPL_REACH_H
+#define __GRAPH_IMPL_REACH_H
+
+#include "vertex.h"
+#include "detail/parallel.h"
+#include <vector>
+
+namespace graph {
+namespace impl {
+
+const VertexIndex removed = (VertexIndex)-1; ///< Index of a vertex that is no longer in the graph.
+
+/*
+ * Computes the vertices that are reachable from vertex 0.
+ *
+ * On return, index[v] is the position of v among the reachable vertices (in the
+ * original order, so vertex 0 keeps index 0), or impl::removed if v is not
+ * reachable. Returns the number of reachable vertices.
+ */
+template <typename Vertex>
+size_t reachable(const std::vector<Vertex>& vertices, std::vector<VertexIndex>& index)
+{
+  index.assign(vertices.size(), removed);
+  if (vertices.empty())
+    return 0;
+  std::vector<VertexIndex> todo;
+  todo.push_back(0);
+  index[0] = 0;
+  while (not todo.empty())
+  {
+    const Vertex& v = vertices[todo.back()];
+    todo.pop_back();
+    for (graph::VertexSet::const_iterator w = v.out.begin(); w != v.out.end(); ++w)
+    {
+      if (index[*w] == removed)
+      {
+        index[*w] = 0;
+        todo.push_back(*w);
+      }
+    }
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < index.size(); ++i)
+    if (index[i] != removed)
+      index[i] = count++;
+  return count;
+}
+
+/*
+ * Renumbers the vertices according to index, which maps every vertex to its new
+ * position or to impl::removed. Removed vertices and all edges from or to them
+ * are dropped. The new positions must be distinct and smaller than count, the
+ * number of vertices that are kept.
+ *
+ * Rebuilding the adjacency sets dominates the cost and is spread over
+ * @a threads threads.
+ */
+template <typename Vertex>
+void renumber(std::vector<Vertex>& vertices, const std::vector<VertexIndex>& index,
+              size_t count, size_t threads = 1)
+{
+  parallel_for(vertices.size(), threads, [&](size_t begin, size_t end)
+  {
+    graph::VertexSet temp;
+    for (size_t i = begin; i < end; ++i)
+    {
+      Vertex& v = vertices[i];
+      if (index[i] == removed)
+      {
+        graph::VertexSet().swap(v.out);
+        graph::VertexSet().swap(v.in);
+        continue;
+      }
+      temp.clear();
+      for (graph::VertexSet::const_iterator w = v.out.begin(); w != v.out.end(); ++w)
+        if (index[*w] != removed)
+          temp.insert(index[*w]);
+      v.out.swap(temp);
+      temp.clear();
+      for (graph::VertexSet::const_iterator w = v.in.begin(); w != v.in.end(); ++w)
+        if (index[*w] != removed)
+          temp.insert(index[*w]);
+      v.in.swap(temp);
+    }
+  });
+  std::vector<Vertex> result(count);
+  for (size_t i = 0; i < vertices.size(); ++i)
+  {
+    if (index[i] != removed)
+    {
+      Vertex& v = result[index[i]];
+      v.label = vertices[i].label;
+      v.out.swap(vertices[i].out);
+      v.in.swap(vertices[i].in);
+    }
+  }
+  vertices.swap(result);
+}
+
+} // namespace impl
+} // namespace graph
+
+#endif // __GRAPH_IMPL_REACH_H
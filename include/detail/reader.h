@@ -0,0 +1,263 @@
+#ifndef __GRAPH_IMPL_READER_H
+#define __GRAPH_IMPL_READER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace.h"
+
+namespace graph {
+namespace impl {
+
+/*
+ * Character reader that prefetches its input on a background thread.
+ *
+ * The background thread reads large blocks from the stream buffer of the given
+ * stream into a ring of buffers, while the parser consumes earlier blocks
+ * through peek() and get(). Reading from the stream (including any
+ * decompression it performs) therefore overlaps with parsing. The reader keeps
+ * track of the line and column of the next character for error messages, and
+ * of the time the parser spent waiting for input.
+ *
+ * The reader consumes the stream up to its end, regardless of how much of it
+ * is parsed.
+ */
+class InputReader
+{
+  public:
+    static const int eof = -1;
+
+    InputReader(std::istream& s, size_t blocks = 4, size_t blocksize = 1 << 20) :
+      m_source(s.rdbuf()), m_blocks(blocks, std::vector<char>(blocksize)),
+      m_current(blocks), m_pos(NULL), m_end(NULL), m_offset(0), m_line(1),
+      m_line_start(0), m_wait(0), m_stop(false), m_done(false)
+    {
+      for (size_t i = 0; i < blocks; ++i)
+        m_free.push_back(i);
+      m_thread = std::thread(&InputReader::produce, this);
+    }
+    ~InputReader()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_changed.notify_all();
+      m_thread.join();
+    }
+    int peek()
+    {
+      if (m_pos == m_end and not next())
+        return eof;
+      return (unsigned char)*m_pos;
+    }
+    int get()
+    {
+      int c = peek();
+      if (c != eof)
+        ++m_pos;
+      return c;
+    }
+    /// Skips whitespace.
+    void skip_space()
+    {
+      for (int c = peek(); c == ' ' or c == '\t' or c == '\n' or c == '\r'; c = peek())
+      {
+        ++m_pos;
+        if (c == '\n')
+          newline();
+      }
+    }
+    /// Skips all characters up to and including @a delim. Returns false at end of input.
+    bool skip_past(char delim)
+    {
+      for (int c = get(); c != eof; c = get())
+      {
+        if (c == '\n')
+          newline();
+        if (c == delim)
+          return true;
+      }
+      return false;
+    }
+    /// Reads a decimal number. Returns false, consuming nothing, if there is no digit.
+    bool read_uint(unsigned long long& value)
+    {
+      int c = peek();
+      if (c < '0' or c > '9')
+        return false;
+      const unsigned long long max = std::numeric_limits<unsigned long long>::max();
+      value = 0;
+      do
+      {
+        unsigned int digit = c - '0';
+        if (value > (max - digit) / 10)
+          return false;
+        value = value * 10 + digit;
+        ++m_pos;
+        c = peek();
+      }
+      while (c >= '0' and c <= '9');
+      return true;
+    }
+    /// Reads a (possibly empty) sequence of letters.
+    std::string read_word()
+    {
+      std::string word;
+      for (int c = peek(); (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z'); c = peek())
+      {
+        word += (char)c;
+        ++m_pos;
+      }
+      return word;
+    }
+    /// Reads up to @a limit characters up to the next whitespace, for use in error messages.
+    std::string read_token(size_t limit = 32)
+    {
+      std::string token;
+      for (int c = peek(); c != eof and c != ' ' and c != '\t' and c != '\n' and c != '\r'
+           and token.size() < limit; c = peek())
+      {
+        token += (char)c;
+        ++m_pos;
+      }
+      return token;
+    }
+    /*
+     * Consumes the unread part of the current block, or else the next block,
+     * and returns it as [begin, end). The characters remain valid until the next
+     * call. Returns false at the end of the input. Line and column are not
+     * updated by this function.
+     */
+    bool read_block(const char*& begin, const char*& end)
+    {
+      if (m_pos == m_end and not next())
+        return false;
+      begin = m_pos;
+      end = m_end;
+      m_pos = m_end;
+      return true;
+    }
+    /// Line of the next character, counting from 1.
+    size_t line() const
+    {
+      return m_line;
+    }
+    /// Column of the next character, counting from 1.
+    size_t column() const
+    {
+      return offset() - m_line_start + 1;
+    }
+    /// Seconds that the parser spent waiting for input.
+    double wait_time() const
+    {
+      return m_wait;
+    }
+  private:
+    std::streambuf* m_source;
+    std::vector<std::vector<char> > m_blocks;
+    std::deque<size_t> m_free; // Blocks that may be filled by the background thread.
+    std::deque<std::pair<size_t, size_t> > m_filled; // Filled blocks and their sizes.
+    size_t m_current; // Block currently being parsed, or m_blocks.size().
+    const char* m_pos;
+    const char* m_end;
+    size_t m_offset; // Offset of the end of the current block in the input.
+    size_t m_line;
+    size_t m_line_start;
+    double m_wait;
+    bool m_stop;
+    bool m_done; // The background thread has reached the end of the input.
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::thread m_thread;
+
+    size_t offset() const
+    {
+      return m_offset - (m_end - m_pos);
+    }
+    void newline()
+    {
+      ++m_line;
+      m_line_start = offset();
+    }
+    bool next()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_current < m_blocks.size())
+      {
+        m_free.push_back(m_current);
+        m_current = m_blocks.size();
+        m_changed.notify_all();
+      }
+      if (m_filled.empty() and not m_done)
+      {
+        trace::span wait("wait for input");
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        m_changed.wait(lock, [this] { return m_done or not m_filled.empty(); });
+        m_wait += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+      if (m_filled.empty())
+      {
+        if (m_error)
+          std::rethrow_exception(m_error);
+        return false;
+      }
+      std::pair<size_t, size_t> block = m_filled.front();
+      m_filled.pop_front();
+      m_current = block.first;
+      m_pos = &m_blocks[block.first][0];
+      m_end = m_pos + block.second;
+      m_offset += block.second;
+      return true;
+    }
+    void produce()
+    {
+      for (;;)
+      {
+        size_t block;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_changed.wait(lock, [this] { return m_stop or not m_free.empty(); });
+          if (m_stop)
+            return;
+          block = m_free.front();
+          m_free.pop_front();
+        }
+        std::streamsize size = 0;
+        try
+        {
+          trace::span read("read");
+          size = m_source->sgetn(&m_blocks[block][0], m_blocks[block].size());
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_error = std::current_exception();
+        }
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          if (size > 0)
+            m_filled.push_back(std::make_pair(block, (size_t)size));
+          else
+            m_done = true;
+        }
+        m_changed.notify_all();
+        if (size <= 0)
+          return;
+      }
+    }
+};
+
+} // namespace impl
+} // namespace graph
+
+#endif // __GRAPH_IMPL_READER_H
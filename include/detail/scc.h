@@ -13,24 +13,37 @@ namespace graph {
 namespace impl {
 
 #ifdef __GNU_LIBRARY__
-  typedef __gnu_cxx::slist<size_t> stack_t; ///< List of vertices (used when VertexSet is too expensive).
+  typedef __gnu_cxx::slist<VertexIndex> stack_t; ///< List of vertices (used when VertexSet is too expensive).
 #else
-  typedef std::list<size_t> stack_t; ///< List of vertices (used when VertexSet is too expensive).
+  typedef std::list<VertexIndex> stack_t; ///< List of vertices (used when VertexSet is too expensive).
 #endif
 
+/// Callback for tarjan_iterative that ignores the SCCs it is given.
+struct ignore_scc
+{
+  void operator()(VertexIndex, const std::vector<VertexIndex>&) {}
+};
+
 /*
  * Iterative implementation of Tarjan's SCC algorithm.
  *
  * Rather than simply assigning the number generated by the algorithm to each SCC,
  * we assign consecutive numbers to SCCs to aid the compression process.
+ *
+ * Every SCC is passed to found(scc_id, members) as soon as it is complete.
+ * SCCs are completed in reverse topological order: at that point, every
+ * vertex that is reachable from the SCC (via edges between equally labelled
+ * vertices) has a smaller SCC number.
  */
-template <typename Vertex>
-size_t tarjan_iterative(const std::vector<Vertex>& vertices, std::vector<VertexIndex>& scc)
+template <typename Vertex, typename Callback>
+size_t tarjan_iterative(const std::vector<Vertex>& vertices, std::vector<VertexIndex>& scc,
+                        Callback found)
 {
-  size_t unused = 1, lastscc = 1;
-  std::vector<size_t> low;
+  VertexIndex unused = 1, lastscc = 1;
+  std::vector<VertexIndex> low;
   stack_t stack;
   stack_t sccstack;
+  std::vector<VertexIndex> members;
   low.resize(vertices.size(), 0);
   for (size_t i = 0; i < vertices.size(); ++i)
   {
@@ -38,7 +51,7 @@ size_t tarjan_iterative(const std::vector<Vertex>& vertices, std::vector<VertexI
       stack.push_front(i);
     while (not stack.empty())
     {
-      size_t vi = stack.front();
+      VertexIndex vi = stack.front();
             const Vertex& v = vertices[vi];
 
       if (low[vi] == 0 and scc[vi] == 0)
@@ -61,15 +74,18 @@ size_t tarjan_iterative(const std::vector<Vertex>& vertices, std::vector<VertexI
         }
         if (low[vi] == scc[vi])
         {
-          size_t tos, scc_id = lastscc++;
+          VertexIndex tos, scc_id = lastscc++;
+          members.clear();
           do
           {
             tos = sccstack.front();
             low[tos] = 0;
             scc[tos] = scc_id;
+            members.push_back(tos);
             sccstack.pop_front();
           }
           while (tos != vi);
+          found(scc_id, members);
         }
         stack.pop_front();
       }
@@ -79,7 +95,18 @@ size_t tarjan_iterative(const std::vector<Vertex>& vertices, std::vector<VertexI
 }
 
 template <typename Vertex>
-void collapse(std::vector<Vertex>& vertices, std::vector<VertexIndex>& sccs)
+size_t tarjan_iterative(const std::vector<Vertex>& vertices, std::vector<VertexIndex>& scc)
+{
+  return tarjan_iterative(vertices, scc, ignore_scc());
+}
+
+/*
+ * Collapses every SCC to a single vertex. If mapping is given, mapping[v] is set
+ * to the index of the vertex that represents v after collapsing.
+ */
+template <typename Vertex>
+void collapse(std::vector<Vertex>& vertices, std::vector<VertexIndex>& sccs,
+              std::vector<VertexIndex>* mapping = NULL)
 {
   graph::VertexSet temp;
 
@@ -95,6 +122,10 @@ void collapse(std::vector<Vertex>& vertices, std::vector<VertexIndex>& sccs)
     else
       --sccs[i];
   }
+  // SCC representatives end up at the index of their SCC, so at this point sccs
+  // maps every vertex to its position after collapsing.
+  if (mapping)
+    *mapping = sccs;
 
   for (size_t i = 0; i < vertices.size(); ++i)
   {
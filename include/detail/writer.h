@@ -0,0 +1,252 @@
+#ifndef __GRAPH_IMPL_WRITER_H
+#define __GRAPH_IMPL_WRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "trace.h"
+
+namespace graph {
+namespace impl {
+
+/*
+ * Writes blocks of characters to a stream on a background thread.
+ *
+ * Blocks are handed over by swapping buffers, so that the caller can format the
+ * next block while the previous ones are being written (and possibly
+ * compressed by the stream). The writer keeps track of the time the caller
+ * spent waiting for a free buffer.
+ */
+class AsyncWriter
+{
+  public:
+    AsyncWriter(std::ostream& s, size_t blocks = 3) :
+      m_stream(s), m_free(blocks), m_wait(0), m_done(false)
+    {
+      m_thread = std::thread(&AsyncWriter::consume, this);
+    }
+    ~AsyncWriter()
+    {
+      stop();
+    }
+    /*
+     * Queues the first @a size characters of @a data for writing. The contents
+     * of @a data are replaced by a free buffer of at least the same size.
+     */
+    void write(std::vector<char>& data, size_t size)
+    {
+      size_t capacity = data.size();
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_free.empty())
+      {
+        trace::span wait("wait for output buffer");
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        m_changed.wait(lock, [this] { return not m_free.empty(); });
+        m_wait += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+      m_filled.push_back(std::make_pair(std::vector<char>(), size));
+      m_filled.back().first.swap(data);
+      data.swap(m_free.back());
+      m_free.pop_back();
+      lock.unlock();
+      m_changed.notify_all();
+      if (data.size() < capacity)
+        data.resize(capacity);
+    }
+    /// Waits until all queued blocks are written, and flushes the stream.
+    void finish()
+    {
+      stop();
+      if (m_error)
+        std::rethrow_exception(m_error);
+      m_stream.flush();
+      if (!m_stream)
+        throw std::runtime_error("Could not write output.");
+    }
+    /// Seconds that the caller spent waiting for a free buffer.
+    double wait_time() const
+    {
+      return m_wait;
+    }
+  private:
+    std::ostream& m_stream;
+    std::vector<std::vector<char> > m_free;
+    std::deque<std::pair<std::vector<char>, size_t> > m_filled;
+    double m_wait;
+    bool m_done;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::thread m_thread;
+
+    void stop()
+    {
+      if (not m_thread.joinable())
+        return;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+      }
+      m_changed.notify_all();
+      m_thread.join();
+    }
+    void consume()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      for (;;)
+      {
+        m_changed.wait(lock, [this] { return m_done or not m_filled.empty(); });
+        if (m_filled.empty())
+          return;
+        std::vector<char> data;
+        data.swap(m_filled.front().first);
+        size_t size = m_filled.front().second;
+        m_filled.pop_front();
+        lock.unlock();
+        try
+        {
+          trace::span write("write");
+          if (not m_error)
+            m_stream.write(&data[0], size);
+        }
+        catch (...)
+        {
+          m_error = std::current_exception();
+        }
+        lock.lock();
+        m_free.push_back(std::vector<char>());
+        m_free.back().swap(data);
+        m_changed.notify_all();
+      }
+    }
+};
+
+/*
+ * Character buffer for writing large amounts of formatted output.
+ *
+ * Integers are formatted directly into the buffer, without the locale handling
+ * of std::ostream. If the buffer is attached to a writer, it is handed to that
+ * writer in blocks of the given capacity; otherwise it grows as needed, so that
+ * several buffers can be filled independently and written in order afterwards.
+ */
+class OutputBuffer
+{
+  public:
+    OutputBuffer(AsyncWriter* writer = NULL, size_t capacity = 1 << 20) :
+      m_writer(writer), m_data(capacity), m_size(0)
+    {
+    }
+    ~OutputBuffer()
+    {
+      flush();
+    }
+    void put(char c)
+    {
+      reserve(1);
+      m_data[m_size++] = c;
+    }
+    void put(const char* str)
+    {
+      put(str, std::strlen(str));
+    }
+    void put(const char* str, size_t length)
+    {
+      if (length == 0)
+        return;
+      reserve(length);
+      std::memcpy(&m_data[m_size], str, length);
+      m_size += length;
+    }
+    void put_uint(unsigned long long value)
+    {
+      static const char digits[] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+      char buf[20];
+      char* p = buf + sizeof(buf);
+      while (value >= 100)
+      {
+        unsigned int i = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        *--p = digits[i + 1];
+        *--p = digits[i];
+      }
+      if (value >= 10)
+      {
+        unsigned int i = (unsigned int)value * 2;
+        *--p = digits[i + 1];
+        *--p = digits[i];
+      }
+      else
+        *--p = (char)('0' + value);
+      put(p, buf + sizeof(buf) - p);
+    }
+    /*
+     * Appends @a value in 7-bit groups, least significant first, with the high
+     * bit of every byte but the last set (LEB128).
+     */
+    void put_varint(unsigned long long value)
+    {
+      char buf[10];
+      size_t n = 0;
+      while (value >= 0x80)
+      {
+        buf[n++] = (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+      }
+      buf[n++] = (char)value;
+      put(buf, n);
+    }
+    /// Appends the contents of @a other.
+    void put(const OutputBuffer& other)
+    {
+      if (other.m_size)
+        put(&other.m_data[0], other.m_size);
+    }
+    /// Hands the buffered characters to the attached writer, if any.
+    void flush()
+    {
+      if (m_writer and m_size)
+      {
+        m_writer->write(m_data, m_size);
+        m_size = 0;
+      }
+    }
+    void clear()
+    {
+      m_size = 0;
+    }
+    size_t size() const
+    {
+      return m_size;
+    }
+  private:
+    AsyncWriter* m_writer;
+    std::vector<char> m_data;
+    size_t m_size;
+
+    void reserve(size_t length)
+    {
+      if (m_size + length <= m_data.size())
+        return;
+      flush();
+      if (m_size + length > m_data.size())
+        m_data.resize(2 * (m_size + length));
+    }
+};
+
+} // namespace impl
+} // namespace graph
+
+#endif // __GRAPH_IMPL_WRITER_H
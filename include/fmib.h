@@ -15,32 +15,15 @@ class FMIBTraits {
 public:
   struct block_t;
 
-  struct vertex_t: public graph::Vertex<Label> {
-    vertex_t() :
-      visitcounter(0), external(0), div(0), pos(false) {
-    }
-    block_t *block; ///< The block to which @c v belongs.
-    size_t visitcounter; ///< Tag used by the partition refinement algorithms.
-    size_t external; ///< Tag used to count the number of blocks that can be reached from @c v in one step.
-    unsigned char div :2; ///< Tag used to record how @c can diverge
-    unsigned char pos :1;
-    void visit() {
-      ++visitcounter;
-    }
-    void clear() {
-      visitcounter = 0;
-    }
-    bool visited() {
-      return visitcounter > 0;
-    }
-  };
-
+  typedef graph::Vertex<Label> vertex_t;
   typedef graph::KripkeStructure<vertex_t> graph_t;
+  /// Per-vertex state; @c external counts the blocks that a vertex can reach in one step.
+  typedef graph::PartitionerTraits::counter_state_t<block_t> state_t;
   typedef VertexList vertexlist_t;
 
   struct block_t: public graph::PartitionerTraits::block_t {
-    block_t(graph_t& pg, size_t index) :
-      graph::PartitionerTraits::block_t(index), pg(pg) {
+    block_t(const graph_t& pg, state_t& state, size_t index) :
+      graph::PartitionerTraits::block_t(index), pg(pg), state(state) {
     }
     bool update(graph::PartitionerTraits::block_t* has_edge_from = NULL) {
       bool result = false;
@@ -49,32 +32,26 @@ public:
       exit.clear();
       size = 0;
       assert(!vertices.empty());
-      vertex_t repr = pg.vertex(*vertices.begin()); // Representative used to decide whether we contain multiple players.
-
-      // In initial update, set the .external fields right (assume they were initialised to 0)
-
-      for (VertexList::const_iterator i = vertices.begin(); i != vertices.end(); ++i) {
-        vertex_t& v = pg.vertex(*i);
-
-      }
+      const vertex_t& repr = pg.vertex(*vertices.begin()); // Representative used to decide whether we contain multiple players.
 
       std::set<size_t> reach_blocks;
       for (VertexList::const_iterator i = vertices.begin(); i != vertices.end(); ++i) {
-        vertex_t& v = pg.vertex(*i);
+        const vertex_t& v = pg.vertex(*i);
+        state.statistics.update_edges += v.in.size() + v.out.size();
         ++size;
         mixed_players = mixed_players || (repr.label.player != v.label.player);
 
         // Record the number of blocks that v can reach
         for (VertexSet::const_iterator dst = v.out.begin(); dst != v.out.end(); ++dst)
-          reach_blocks.insert(pg.vertex(*dst).block->index);
-        v.external = reach_blocks.size();
+          reach_blocks.insert(state.block[*dst]->index);
+        state.external[*i] = reach_blocks.size();
         reach_blocks.clear();
 
         // record incoming edges.
         for (VertexSet::const_iterator src = v.in.begin(); src != v.in.end(); ++src) {
           incoming.push_front(*src);
           // record edges has_edge_from -> this
-          if (pg.vertex(*src).block == has_edge_from) {
+          if (state.block[*src] == has_edge_from) {
             result = true;
           }
         }
@@ -83,7 +60,8 @@ public:
       return result;
     }
     size_t size;
-    graph_t& pg; ///< The partition(er) to which the block belongs.
+    const graph_t& pg; ///< The graph that is being partitioned.
+    state_t& state; ///< The per-vertex state of the partitioner.
     vertexlist_t exit; ///< A list of vertices in the block that have only outgoing edges to other blocks.
     bool mixed_players;
   };
@@ -106,7 +84,8 @@ public:
   typedef typename base_t::blocklist_t blocklist_t;
   using base_t::m_blocks;
   using base_t::m_pg;
-  FMIBPartitioner(graph_t& pg) :
+  using base_t::m_state;
+  FMIBPartitioner(const graph_t& pg) :
     base_t(pg) {
   }
   const blocklist_t blocks() const {
@@ -114,7 +93,7 @@ public:
   }
   block_t&
   newblock() {
-    m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+    m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
     return m_blocks.back();
   }
 protected:
@@ -131,13 +110,13 @@ protected:
     // Note that blocks are per *priority*, and not per label
     // in this case.
     for (size_t i = m_pg.size() - 1; i != (size_t) -1; --i) {
-      vertex_t &v = m_pg.vertex(i);
+      const vertex_t &v = m_pg.vertex(i);
       typename pmap::iterator B = blocks.find(v.label.prio);
       if (B == blocks.end()) {
-        m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+        m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
         B = blocks.insert(std::make_pair(v.label.prio, &m_blocks.back())).first;
       }
-      v.block = B->second;
+      m_state.block[i] = B->second;
       B->second->vertices.push_front(i);
     }
 
@@ -146,19 +125,19 @@ protected:
     {
       B->update();
 
-      if(cpplogEnabled(cpplogging::debug1, "partitioner"))
+      if(graphlogEnabled(cpplogging::debug1, "partitioner"))
       {
-        cpplog(cpplogging::debug1, "partitioner")
+        graphlog(cpplogging::debug1, "partitioner")
             << "  block #" << B->index << " initially contains the following vertices: " << std::endl;
         for(VertexList::const_iterator i = B->vertices.begin(); i != B->vertices.end(); ++i)
         {
                     if(i != B->vertices.begin())
                     {
-                      cpplog(cpplogging::debug1, "partitioner") << ", ";
+                      graphlog(cpplogging::debug1, "partitioner") << ", ";
                     }
-          cpplog(cpplogging::debug1, "partitioner") << *i;
+          graphlog(cpplogging::debug1, "partitioner") << *i;
         }
-        cpplog(cpplogging::debug1, "partitioner") << std::endl;
+        graphlog(cpplogging::debug1, "partitioner") << std::endl;
       }
     }
 
@@ -175,19 +154,18 @@ protected:
     bool all_states_visited = true, no_states_visited = true;
     for (VertexList::const_iterator v = B1->vertices.begin(); v != B1->vertices.end(); ++v)
     {
-      vertex_t& vertex = m_pg.vertex(*v);
-      if (vertex.visited())
+      if (m_state.visited(*v))
       {
         no_states_visited = false;
-        vertex.pos = true;
+        m_state.pos[*v] = true;
       } else
         all_states_visited = false;
     }
     if (all_states_visited)
       for (VertexList::const_iterator v = B1->vertices.begin(); v != B1->vertices.end(); ++v)
-        m_pg.vertex(*v).pos = false;
+        m_state.pos[*v] = false;
     bool result = ! (all_states_visited || no_states_visited);
-    cpplog(cpplogging::debug1, "split") << B1->index << ", " << B2->index << ": " << std::boolalpha << result << std::endl;
+    graphlog(cpplogging::debug1, "split") << B1->index << ", " << B2->index << ": " << std::boolalpha << result << std::endl;
     return result;
   }
 
@@ -206,11 +184,11 @@ protected:
     bool result;
 
     result = split(B, even);
-    cpplog(cpplogging::debug1, "split") << B->index << ", even: " << std::boolalpha << result << std::endl;
+    graphlog(cpplogging::debug1, "split") << B->index << ", even: " << std::boolalpha << result << std::endl;
     if (!result)
     {
       result = split(B, odd);
-      cpplog(cpplogging::debug1, "split") << B->index << ", odd: " << std::boolalpha << result << std::endl;
+      graphlog(cpplogging::debug1, "split") << B->index << ", odd: " << std::boolalpha << result << std::endl;
     }
 
     if (!result)
@@ -218,62 +196,32 @@ protected:
       for (VertexList::const_iterator src = B->incoming.begin();
           src != B->incoming.end(); ++src)
       {
-        vertex_t& v = m_pg.vertex(*src);
-        v.visit();
-        v.block->visited = false;
+        m_state.visit(*src);
+        m_state.block[*src]->visited = false;
       }
 
       result = split(B, B);
 
       for (VertexList::const_iterator src = B->incoming.begin();
           src != B->incoming.end(); ++src)
-      {
-        vertex_t& v = m_pg.vertex(*src);
-        v.clear();
-      }
+        m_state.clear(*src);
     }
 
     return result;
   }
 
   /**
-   * @brief Quotients the parity game and stores the result in @a g.
+   * @brief Labels the vertex that represents @a B in the quotient (see
+   *   Partitioner::describe).
    *
    * Quotienting is done by viewing each block as a vertex. The priority and player of a
    * block are defined as the priority and player of the first vertex in the block's
    * @c vertices member.
-   *
-   * @param quotient ParityGame in which the quotient is stored.
    */
-  void quotient(graph_t& quotient)
+  int describe(const block_t& B, typename vertex_t::label_t& label)
   {
-    quotient.resize(m_blocks.size());
-    size_t src, dst, vc = 1;
-
-    // Make sure node 0 is in block 0
-    size_t oldblock = m_pg.vertex(0).block->index;
-    m_pg.vertex(0).block->index = 0;
-    m_blocks.front().index = oldblock;
-
-    for (typename blocklist_t::const_iterator B = m_blocks.begin(); B != m_blocks.end(); ++B, ++vc)
-    {
-      dst = B->index;
-      VertexList::const_iterator v = B->vertices.begin();
-      vertex_t& repr = quotient.vertex(dst);
-      repr.label = m_pg.vertex(*v).label;
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv != B->incoming.end(); ++sv)
-        m_pg.vertex(m_pg.vertex(*sv).block->index).clear();
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv != B->incoming.end(); ++sv)
-      {
-        src = m_pg.vertex(*sv).block->index;
-        if (!m_pg.vertex(src).visited())
-        {
-          quotient.vertex(src).out.insert(dst);
-          repr.in.insert(src);
-          m_pg.vertex(src).visit();
-        }
-      }
-    }
+    label = m_pg.vertex(B.vertices.front()).label;
+    return this->no_self_loop;
   }
 private:
   /**
@@ -298,12 +246,12 @@ private:
       if(v.label.player == p)
       {
 
-        cpplog(cpplogging::debug1, "split") << "        "
+        graphlog(cpplogging::debug1, "split") << "        "
                       << "vertex " << *vi << " owned by player " << v.label.player
                       << " has edges to multiple blocks? " << std::boolalpha
-                      << (m_pg.vertex(*vi).external > 1) << std::endl;
+                      << (m_state.external[*vi] > 1) << std::endl;
 
-        result = result || (m_pg.vertex(*vi).external > 1);
+        result = result || (m_state.external[*vi] > 1);
 
       }
     }
@@ -313,8 +261,8 @@ private:
       for (VertexList::const_iterator vi = B->vertices.begin(); vi != B->vertices.end(); ++vi)
       {
         const vertex_t& v = m_pg.vertex(*vi);
-        if(v.label.player == p && m_pg.vertex(*vi).external > 1)
-          m_pg.vertex(*vi).pos = true;
+        if(v.label.player == p && m_state.external[*vi] > 1)
+          m_state.pos[*vi] = true;
       }
     }
 
@@ -14,32 +14,15 @@ class GovernedStutteringTraits {
 public:
   struct block_t;
 
-  struct vertex_t: public graph::Vertex<Label> {
-    vertex_t() :
-      visitcounter(0), external(0), div(0), pos(false) {
-    }
-    block_t *block; ///< The block to which @c v belongs.
-    size_t visitcounter; ///< Tag used by the partition refinement algorithms.
-    size_t external;
-    unsigned char div :2;
-    unsigned char pos :1;
-    void visit() {
-      ++visitcounter;
-    }
-    void clear() {
-      visitcounter = 0;
-    }
-    bool visited() {
-      return visitcounter > 0;
-    }
-  };
-
+  typedef graph::Vertex<Label> vertex_t;
   typedef graph::KripkeStructure<vertex_t> graph_t;
+  /// Per-vertex state; @c external counts the edges that leave a vertex's block.
+  typedef graph::PartitionerTraits::counter_state_t<block_t> state_t;
   typedef VertexList vertexlist_t;
 
   struct block_t: public graph::PartitionerTraits::block_t {
-    block_t(graph_t& pg, size_t index) :
-      graph::PartitionerTraits::block_t(index), pg(pg) {
+    block_t(const graph_t& pg, state_t& state, size_t index) :
+      graph::PartitionerTraits::block_t(index), pg(pg), state(state) {
     }
     bool update(graph::PartitionerTraits::block_t* has_edge_from = NULL) {
       bool result = false;
@@ -50,24 +33,25 @@ public:
       if (has_edge_from == NULL) {
         for (VertexList::const_iterator i = vertices.begin(); i
             != vertices.end(); ++i) {
-          vertex_t& v = pg.vertex(*i);
+          const vertex_t& v = pg.vertex(*i);
           for (VertexSet::const_iterator dst = v.out.begin(); dst
               != v.out.end(); ++dst)
-            if (this != pg.vertex(*dst).block)
-              ++v.external;
+            if (this != state.block[*dst])
+              ++state.external[*i];
         }
       }
       for (VertexList::const_iterator i = vertices.begin(); i
           != vertices.end(); ++i) {
-        vertex_t& v = pg.vertex(*i);
+        const vertex_t& v = pg.vertex(*i);
+        state.statistics.update_edges += v.in.size() + v.out.size();
         ++size;
         for (VertexSet::const_iterator src = v.in.begin(); src
             != v.in.end(); ++src) {
-          if (pg.vertex(*src).block != this) {
+          if (state.block[*src] != this) {
             incoming.push_front(*src);
-            if (pg.vertex(*src).block == has_edge_from) {
+            if (state.block[*src] == has_edge_from) {
               result = true;
-              ++pg.vertex(*src).external;
+              ++state.external[*src];
             }
           }
         }
@@ -75,7 +59,7 @@ public:
         //       for exits.
         for (VertexSet::const_iterator dst = v.out.begin(); dst
             != v.out.end(); ++dst) {
-          if (pg.vertex(*dst).block != this) {
+          if (state.block[*dst] != this) {
             exit.push_front(*i);
             break;
           }
@@ -84,7 +68,8 @@ public:
       return result;
     }
     size_t size;
-    graph_t& pg; ///< The partition(er) to which the block belongs.
+    const graph_t& pg; ///< The graph that is being partitioned.
+    state_t& state; ///< The per-vertex state of the partitioner.
     vertexlist_t exit; ///< A list of vertices in the block that have only outgoing edges to other blocks.
   };
 
@@ -109,7 +94,8 @@ public:
       blocklist_t;
   using Partitioner<GovernedStutteringTraits<Label> >::m_blocks;
   using Partitioner<GovernedStutteringTraits<Label> >::m_pg;
-  GovernedStutteringPartitioner(graph_t& pg) :
+  using Partitioner<GovernedStutteringTraits<Label> >::m_state;
+  GovernedStutteringPartitioner(const graph_t& pg) :
     graph::Partitioner<GovernedStutteringTraits<Label> >(pg) {
   }
   const blocklist_t blocks() const {
@@ -117,7 +103,7 @@ public:
   }
   block_t&
   newblock() {
-    m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+    m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
     return m_blocks.back();
   }
 protected:
@@ -132,14 +118,14 @@ protected:
 
     // Assign blocks to vertices
     for (size_t i = m_pg.size() - 1; i != (size_t) -1; --i) {
-      vertex_t &v = m_pg.vertex(i);
+      const vertex_t &v = m_pg.vertex(i);
       typename pmap::iterator B = blocks.find(v.label.prio);
       if (B == blocks.end()) {
-        m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+        m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
         B = blocks.insert(
             std::make_pair(v.label.prio, &m_blocks.back())).first;
       }
-      v.block = B->second;
+      m_state.block[i] = B->second;
       B->second->vertices.push_front(i);
     }
 
@@ -162,7 +148,7 @@ protected:
    */
   bool split(const block_t* B1, const block_t* B2) {
 
-    switch (m_pg.vertex(B1->vertices.front()).div) {
+    switch (m_state.div[B1->vertices.front()]) {
     case 3:
       /** Both players are divergent
        *
@@ -187,10 +173,10 @@ protected:
       for (VertexList::const_iterator vi = B1->exit.begin(); vi
           != B1->exit.end() and not (bottom_error or (even_rules
           and odd_rules)); ++vi) {
-        vertex_t& v = m_pg.vertex(*vi);
-        if (v.external == v.out.size() and not v.visited())
+        const vertex_t& v = m_pg.vertex(*vi);
+        if (m_state.external[*vi] == v.out.size() and not m_state.visited(*vi))
           bottom_error = true;
-        else if (v.visitcounter != v.external) {
+        else if (m_state.visitcounter[*vi] != m_state.external[*vi]) {
           if (v.label.player == odd)
             odd_rules = true;
           else
@@ -211,7 +197,7 @@ protected:
 
     for (VertexList::const_iterator vi = B->vertices.begin(); vi
         != B->vertices.end(); ++vi)
-      m_pg.vertex(*vi).div = 3;
+      m_state.div[*vi] = 3;
 
     result = split(B, even);
     if (not result)
@@ -219,59 +205,36 @@ protected:
 
     for (VertexList::const_iterator vi = B->vertices.begin(); vi
         != B->vertices.end(); ++vi)
-      m_pg.vertex(*vi).clear();
+      m_state.clear(*vi);
 
     return result;
   }
   /**
-   * @brief Quotients the parity game and stores the result in @a g.
+   * @brief Labels the vertex that represents @a B in the quotient (see
+   *   Partitioner::describe).
    *
    * Quotienting is done by viewing each block as a vertex. The priority and player of a
    * block are defined as the priority and player of the first vertex in the block's
-   * @c vertices member.
-   * @param g ParityGame in which the quotient is stored.
+   * @c vertices member that has an edge to another block. Blocks that are
+   * divergent for that player get a self-loop, which is added to both adjacency
+   * sets so that the quotient can be partitioned again.
    */
-  void quotient(graph_t& g) {
-    g.resize(m_blocks.size());
-
-    for (VertexIndex i = 0; i < m_pg.size(); ++i)
-      m_pg.vertex(i).visitcounter = 0;
-
-    // Make sure node 0 is in block 0
-    size_t oldblock = m_pg.vertex(0).block->index;
-    m_pg.vertex(0).block->index = 0;
-    m_blocks.front().index = oldblock;
-
-    size_t src, dst, vc = 1;
-    for (typename blocklist_t::const_iterator B = m_blocks.begin(); B
-        != m_blocks.end(); ++B, ++vc) {
-      dst = B->index;
-      VertexIndex v;
-      vertex_t& repr = g.vertex(dst);
-      for (VertexList::const_iterator it = B->vertices.begin(); it
-          != B->vertices.end(); ++it) {
-        v = *it;
-        if (m_pg.vertex(v).external)
-          break;
-      }
-      vertex_t& orig = m_pg.vertex(v);
-
-      repr.label.player = orig.label.player;
-      repr.label.prio = orig.label.prio;
-      if (divergent(&(*B), (Player) repr.label.player))
-        repr.out.insert(dst);
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv
-          != B->incoming.end(); ++sv) {
-        src = m_pg.vertex(*sv).block->index;
-        if (m_pg.vertex(src).visitcounter != vc) {
-          g.vertex(src).out.insert(dst);
-          repr.in.insert(src);
-          m_pg.vertex(src).visitcounter = vc;
-        }
-      }
+  int describe(const block_t& B, typename vertex_t::label_t& label) {
+    VertexIndex v;
+    for (VertexList::const_iterator it = B.vertices.begin(); it
+        != B.vertices.end(); ++it) {
+      v = *it;
+      if (m_state.external[v])
+        break;
     }
+    const vertex_t& orig = m_pg.vertex(v);
+
+    label = orig.label;
+    if (divergent(&B, (Player) label.player))
+      return this->self_loop;
+    return this->no_self_loop;
   }
-private:
+protected:
   /**
    * Tries to split @a B1 given that @a todo contains the relevant bottom vertices. The
    * vertices from which @a p can reach @a todo are stored in @a pos.
@@ -286,10 +249,10 @@ private:
 
     for (VertexList::const_iterator vi = B->vertices.begin(); vi
         != B->vertices.end(); ++vi) {
-      vertex_t& v = m_pg.vertex(*vi);
-      v.visitcounter = v.external;
-      if (v.visitcounter == v.out.size() or (v.label.player == p
-          and v.visited()))
+      const vertex_t& v = m_pg.vertex(*vi);
+      m_state.visitcounter[*vi] = m_state.external[*vi];
+      if (m_state.visitcounter[*vi] == v.out.size() or (v.label.player == p
+          and m_state.visited(*vi)))
         todo.push_front(*vi);
     }
 
@@ -298,7 +261,7 @@ private:
     if (pos_size == 0 or pos_size == B->size) {
       for (VertexList::const_iterator vi = B->vertices.begin(); vi
           != B->vertices.end(); ++vi)
-        m_pg.vertex(*vi).pos = false;
+        m_state.pos[*vi] = false;
       return false;
     }
     return true;
@@ -313,10 +276,10 @@ private:
 
     oldcounters.resize(B1->size);
     for (vi = B1->vertices.begin(), i = 0; vi != B1->vertices.end(); ++vi, ++i) {
-      vertex_t& v = m_pg.vertex(*vi);
-      oldcounters[i] = v.visitcounter;
-      if (v.visitcounter == v.out.size() or (v.label.player == even
-          and v.visited()))
+      const vertex_t& v = m_pg.vertex(*vi);
+      oldcounters[i] = m_state.visitcounter[*vi];
+      if (m_state.visitcounter[*vi] == v.out.size() or (v.label.player == even
+          and m_state.visited(*vi)))
         todo.push_front(*vi);
     }
 
@@ -327,11 +290,11 @@ private:
 
     todo.clear();
     for (vi = B1->vertices.begin(), i = 0; vi != B1->vertices.end(); ++vi, ++i) {
-      vertex_t& v = m_pg.vertex(*vi);
-      m_pg.vertex(*vi).visitcounter = oldcounters[i];
-      m_pg.vertex(*vi).pos = false;
-      if (v.visitcounter == v.out.size() or (v.label.player == odd
-          and v.visited()))
+      const vertex_t& v = m_pg.vertex(*vi);
+      m_state.visitcounter[*vi] = oldcounters[i];
+      m_state.pos[*vi] = false;
+      if (m_state.visitcounter[*vi] == v.out.size() or (v.label.player == odd
+          and m_state.visited(*vi)))
         todo.push_front(*vi);
     }
 
@@ -339,8 +302,8 @@ private:
 
     if (pos_size == 0 or pos_size == B1->size) {
       for (vi = B1->vertices.begin(), i = 0; vi != B1->vertices.end(); ++vi, ++i) {
-        m_pg.vertex(*vi).clear();
-        m_pg.vertex(*vi).pos = false;
+        m_state.clear(*vi);
+        m_state.pos[*vi] = false;
       }
     } else
       return true;
@@ -361,24 +324,24 @@ private:
     size_t result = 0;
 
     for (VertexList::const_iterator it = todo.begin(); it != todo.end(); ++it)
-      m_pg.vertex(*it).pos = true;
+      m_state.pos[*it] = true;
 
     while (not todo.empty()) {
       size_t i = todo.front();
-      vertex_t& v = m_pg.vertex(i);
+      const vertex_t& v = m_pg.vertex(i);
       todo.pop_front();
 
-      v.div &= ~opponent_bm;
+      m_state.div[i] &= ~opponent_bm;
       ++result;
 
       for (VertexSet::const_iterator pred = v.in.begin(); pred
           != v.in.end(); ++pred) {
-        vertex_t& w = m_pg.vertex(*pred);
-        if (w.block == B and not w.pos) {
-          w.visit();
-          if (w.visitcounter == w.out.size() or (w.label.player == p
-              and w.visited())) {
-            w.pos = true;
+        if (m_state.block[*pred] == B and not m_state.pos[*pred]) {
+          const vertex_t& w = m_pg.vertex(*pred);
+          m_state.visit(*pred);
+          if (m_state.visitcounter[*pred] == w.out.size() or (w.label.player == p
+              and m_state.visited(*pred))) {
+            m_state.pos[*pred] = true;
             todo.push_front(*pred);
           }
         }
@@ -386,7 +349,8 @@ private:
     }
     for (VertexList::const_iterator it = B->vertices.begin(); it
         != B->vertices.end(); ++it)
-      m_pg.vertex(*it).clear();
+      m_state.clear(*it);
+    m_state.statistics.attractor_visits += result;
     return result;
   }
 
@@ -401,14 +365,14 @@ private:
     for (VertexList::const_iterator src = B->vertices.begin(); src
         != B->vertices.end(); ++src) {
       const vertex_t& v = m_pg.vertex(*src);
-      if (v.external == 0)
+      if (m_state.external[*src] == 0)
         continue;
       if (v.label.player != p)
         return false;
       bool can_stay_in_block = false;
       for (VertexSet::const_iterator vi = v.out.begin(); vi
           != v.out.end(); ++vi)
-        if (m_pg.vertex(*vi).block == B) {
+        if (m_state.block[*vi] == B) {
           can_stay_in_block = true;
           break;
         }
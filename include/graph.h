@@ -4,6 +4,8 @@
 #include <vector>
 #include <set>
 #include "detail/scc.h"
+#include "detail/reach.h"
+#include "detail/order.h"
 #include "vertex.h"
 
 namespace graph
@@ -38,6 +40,11 @@ namespace graph
         {
           return m_vertices[index];
         }
+        const vertex_t&
+        vertex(size_t index) const
+        {
+          return m_vertices[index];
+        }
         /**
          * @brief Returns the number of vertices in the game.
          * @return The number of vertices in the game.
@@ -78,14 +85,92 @@ namespace graph
          *
          * Only strongly connected components in which each state has the same player and priority
          * are collapsed.
+         * @param mapping If not @c NULL, receives for every vertex the index of the
+         *   vertex that represents it after collapsing.
          */
         void
-        collapse_sccs()
+        collapse_sccs(std::vector<VertexIndex>* mapping = NULL)
         {
-          std::vector<size_t> scc;
+          if (m_vertices.empty())
+          {
+            if (mapping)
+              mapping->clear();
+            return;
+          }
+          std::vector<VertexIndex> scc;
           scc.resize(m_vertices.size());
           impl::tarjan_iterative(m_vertices, scc);
-          impl::collapse(m_vertices, scc);
+          impl::collapse(m_vertices, scc, mapping);
+        }
+        /**
+         * @brief Remove all vertices that are not reachable from vertex 0.
+         *
+         * The remaining vertices keep their relative order, so vertex 0 remains
+         * vertex 0.
+         * @param threads The number of threads used to renumber the adjacency sets.
+         * @param mapping If not @c NULL, receives for every vertex its new index, or
+         *   impl::removed if it was removed.
+         * @return The number of vertices that were removed.
+         */
+        size_t
+        prune_unreachable(size_t threads = 1, std::vector<VertexIndex>* mapping = NULL)
+        {
+          std::vector<VertexIndex> index;
+          if (m_vertices.empty())
+          {
+            if (mapping)
+              mapping->swap(index);
+            return 0;
+          }
+          size_t count = impl::reachable(m_vertices, index);
+          size_t removed = m_vertices.size() - count;
+          if (removed)
+            impl::renumber(m_vertices, index, count, threads);
+          if (mapping)
+            mapping->swap(index);
+          return removed;
+        }
+        /**
+         * @brief Renumbers the vertices in the given order, to improve locality.
+         *
+         * Vertex 0 remains vertex 0 (see VertexOrder for the other orders).
+         * @param threads The number of threads used to renumber the adjacency sets.
+         * @param mapping If not @c NULL, receives for every vertex its new index.
+         */
+        void
+        reorder(VertexOrder order, size_t threads = 1, std::vector<VertexIndex>* mapping = NULL)
+        {
+          std::vector<VertexIndex> index;
+          impl::order(m_vertices, order, index);
+          impl::renumber(m_vertices, index, m_vertices.size(), threads);
+          if (mapping)
+            mapping->swap(index);
+        }
+        /**
+         * @brief Moves the vertices of @a other behind those of this graph, which
+         *   then holds the disjoint union of both.
+         *
+         * Vertex @e v of @a other becomes vertex @e n + @e v, where @e n is the
+         * number of vertices this graph had before. @a other is left empty.
+         */
+        void
+        append(KripkeStructure& other)
+        {
+          size_t offset = m_vertices.size();
+          m_vertices.resize(offset + other.size());
+          for (size_t i = 0; i < other.size(); ++i)
+          {
+            vertex_t& v = other.m_vertices[i];
+            vertex_t& w = m_vertices[offset + i];
+            w.label = v.label;
+            for (VertexSet::const_iterator j = v.out.begin(); j != v.out.end(); ++j)
+              w.out.insert(w.out.end(), *j + offset);
+            for (VertexSet::const_iterator j = v.in.begin(); j != v.in.end(); ++j)
+              w.in.insert(w.in.end(), *j + offset);
+            VertexSet().swap(v.out);
+            VertexSet().swap(v.in);
+          }
+          vertices_t().swap(other.m_vertices);
         }
       protected:
         vertices_t m_vertices; ///< The vertex array.
@@ -94,6 +179,7 @@ namespace graph
   enum FileFormat
   {
     pgsolver,
+    pgbinary,
     dot,
     aut
   };
@@ -103,6 +189,15 @@ namespace graph
   {
   };
 
+  /**
+   * @brief Writes a game in @a format one vertex at a time, so that it does not
+   *   have to be stored first (see Partitioner::stream_quotient).
+   */
+  template<FileFormat format>
+  class VertexWriter
+  {
+  };
+
 }
 
 #endif // __GRAPH_H
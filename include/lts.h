@@ -3,7 +3,13 @@
 
 #include "vertex.h"
 #include "parsers/dot.h"
+#include "detail/parallel.h"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace graph {
 namespace lts {
@@ -41,6 +47,247 @@ struct DivLabel
     }
 };
 
+typedef unsigned int LabelIndex; ///< Dense index of an action label in a TransitionSystem.
+
+/**
+ * @brief Label of a vertex in the Kripke structure that encodes a labelled transition system.
+ *
+ * States of the transition system are encoded by vertices with action 0. A
+ * transition with label @e a is encoded by a path through a vertex with action
+ * @e a + 1 (see TransitionSystem). The @c div flag marks divergent vertices
+ * after SCC collapsing, like pg::DivLabel does for parity games.
+ */
+struct ActionLabel
+{
+  ActionLabel() : action(0), div(0) {}
+  LabelIndex action;
+  unsigned char div;
+  /// @brief Comparison to make ActionLabel a valid mapping index.
+  bool operator<(const ActionLabel& other) const {
+    return (action < other.action)
+      or (action == other.action and div < other.div);
+  }
+  /// @brief Equality comparison.
+  bool operator==(const ActionLabel& other) const {
+    return (action == other.action) and (div == other.div);
+  }
+};
+
+/**
+ * @brief A labelled transition of a TransitionSystem.
+ */
+struct Transition
+{
+  VertexIndex from;
+  LabelIndex label;
+  VertexIndex to;
+};
+
+/**
+ * @brief Labelled transition system stored as a flat array of transitions.
+ *
+ * Action labels are interned: every distinct label is stored once in @c labels,
+ * and transitions refer to it by its index.
+ */
+struct TransitionSystem
+{
+  static const LabelIndex no_label = (LabelIndex)-1;
+
+  TransitionSystem() : initial(0), states(0) {}
+
+  VertexIndex initial; ///< The initial state.
+  size_t states; ///< The number of states.
+  std::vector<std::string> labels; ///< Action labels, indexed by LabelIndex.
+  std::vector<Transition> transitions;
+
+  /// @brief Returns the index of @a label, adding it to the label table if necessary.
+  LabelIndex
+  label_index(const std::string& label)
+  {
+    std::unordered_map<std::string, LabelIndex>::const_iterator it = m_index.find(label);
+    if (it != m_index.end())
+      return it->second;
+    if (labels.size() >= (LabelIndex)-1)
+      throw std::runtime_error("Too many distinct action labels.");
+    LabelIndex result = (LabelIndex)labels.size();
+    labels.push_back(label);
+    m_index[label] = result;
+    return result;
+  }
+
+  /// @brief Returns the index of @a label, or @c no_label if it does not occur.
+  LabelIndex
+  find_label(const std::string& label) const
+  {
+    std::unordered_map<std::string, LabelIndex>::const_iterator it = m_index.find(label);
+    return it == m_index.end() ? no_label : it->second;
+  }
+
+  /**
+   * @brief Stores the states and transitions in @a graph, ignoring action labels.
+   *
+   * The transitions are first bucketed by source and by target with a counting
+   * sort. The adjacency sets of different vertices are then filled from their
+   * own buckets by @a threads threads concurrently.
+   */
+  template <typename graph_t>
+  void
+  to_graph(graph_t& graph, size_t threads = 1) const
+  {
+    graph.resize(0);
+    graph.resize(states);
+    // The targets of state v are succ[first_out[v]] up to succ[first_out[v + 1]],
+    // and its sources are pred[first_in[v]] up to pred[first_in[v + 1]].
+    std::vector<size_t> first_out(states + 1, 0), first_in(states + 1, 0);
+    for (size_t i = 0; i < transitions.size(); ++i)
+    {
+      ++first_out[transitions[i].from + 1];
+      ++first_in[transitions[i].to + 1];
+    }
+    for (size_t v = 0; v < states; ++v)
+    {
+      first_out[v + 1] += first_out[v];
+      first_in[v + 1] += first_in[v];
+    }
+    std::vector<VertexIndex> succ(transitions.size()), pred(transitions.size());
+    {
+      std::vector<size_t> next_out(first_out.begin(), first_out.end() - 1);
+      std::vector<size_t> next_in(first_in.begin(), first_in.end() - 1);
+      for (size_t i = 0; i < transitions.size(); ++i)
+      {
+        const Transition& t = transitions[i];
+        succ[next_out[t.from]++] = t.to;
+        pred[next_in[t.to]++] = t.from;
+      }
+    }
+    impl::parallel_for(states, threads, [&](size_t begin, size_t end)
+    {
+      for (size_t v = begin; v < end; ++v)
+      {
+        // Sorted buckets let every index be inserted at the end of the set.
+        VertexSet& out = graph.vertex(v).out;
+        std::sort(succ.begin() + first_out[v], succ.begin() + first_out[v + 1]);
+        for (size_t i = first_out[v]; i < first_out[v + 1]; ++i)
+          out.insert(out.end(), succ[i]);
+        VertexSet& in = graph.vertex(v).in;
+        std::sort(pred.begin() + first_in[v], pred.begin() + first_in[v + 1]);
+        for (size_t i = first_in[v]; i < first_in[v + 1]; ++i)
+          in.insert(in.end(), pred[i]);
+      }
+    });
+  }
+
+  /**
+   * @brief Encodes the transition system in the Kripke structure @a graph.
+   *
+   * Vertex @e s of @a graph represents state @e s. Every distinct pair of an
+   * action @e a and a target state @e t is represented by a vertex with action
+   * @e a + 1 (see ActionLabel) that has a single edge to @e t, and every
+   * transition (@e s, @e a, @e t) becomes an edge from @e s to that vertex.
+   * Bisimilarity of the encoding then coincides with strong bisimilarity.
+   *
+   * If @a tau is given, transitions labelled @a tau instead become edges from
+   * @e s to @e t directly, so that stuttering equivalence of the encoding
+   * coincides with branching bisimilarity.
+   */
+  template <typename graph_t>
+  void
+  encode(graph_t& graph, LabelIndex tau = no_label) const
+  {
+    typedef std::pair<LabelIndex, VertexIndex> step_t;
+    std::vector<step_t> steps;
+    for (size_t i = 0; i < transitions.size(); ++i)
+      if (transitions[i].label != tau)
+        steps.push_back(step_t(transitions[i].label, transitions[i].to));
+    std::sort(steps.begin(), steps.end());
+    steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+    if (states + steps.size() > max_vertices)
+      throw std::runtime_error("The encoding of the transition system has too many vertices "
+                               "for this build (see GRAPH_32BIT_INDICES).");
+    graph.resize(0);
+    graph.resize(states + steps.size());
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+      graph.vertex(states + i).label.action = steps[i].first + 1;
+      graph.vertex(states + i).out.insert(steps[i].second);
+      graph.vertex(steps[i].second).in.insert(states + i);
+    }
+    for (size_t i = 0; i < transitions.size(); ++i)
+    {
+      const Transition& t = transitions[i];
+      VertexIndex to = t.to;
+      if (t.label != tau)
+        to = states + (std::lower_bound(steps.begin(), steps.end(), step_t(t.label, t.to)) - steps.begin());
+      graph.vertex(t.from).out.insert(to);
+      graph.vertex(to).in.insert(t.from);
+    }
+  }
+
+  /**
+   * @brief Stores the transition system encoded by @a graph (see encode) in @a result.
+   *
+   * The labels of this transition system are used. Vertex @a init becomes the
+   * initial state 0; the other states are numbered in the order of @a graph.
+   * Edges between states become @a tau transitions. An edge to a vertex that is
+   * marked divergent (i.e. that has @c div set) becomes a @a tau self-loop.
+   * @param index If not @c NULL, receives the state number of every vertex that
+   *   represents a state, and impl::removed for the other vertices.
+   */
+  template <typename graph_t>
+  void
+  decode(const graph_t& graph, VertexIndex init, LabelIndex tau, TransitionSystem& result,
+      std::vector<VertexIndex>* index = NULL) const
+  {
+    const typename graph_t::vertices_t& vertices = graph.vertices();
+    std::vector<VertexIndex> number(vertices.size(), (VertexIndex)-1);
+    result.labels = labels;
+    result.m_index = m_index;
+    result.transitions.clear();
+    result.initial = 0;
+    result.states = 1;
+    number[init] = 0;
+    for (size_t v = 0; v < vertices.size(); ++v)
+      if (v != init and vertices[v].label.action == 0 and not vertices[v].label.div)
+        number[v] = result.states++;
+    for (size_t v = 0; v < vertices.size(); ++v)
+    {
+      if (number[v] == (VertexIndex)-1)
+        continue;
+      for (VertexSet::const_iterator w = vertices[v].out.begin(); w != vertices[v].out.end(); ++w)
+      {
+        const ActionLabel& label = vertices[*w].label;
+        Transition t;
+        t.from = number[v];
+        if (label.div)
+        {
+          t.label = tau;
+          t.to = number[v];
+          result.transitions.push_back(t);
+        }
+        else if (label.action == 0)
+        {
+          t.label = tau;
+          t.to = number[*w];
+          result.transitions.push_back(t);
+        }
+        else
+        {
+          t.label = label.action - 1;
+          for (VertexSet::const_iterator u = vertices[*w].out.begin(); u != vertices[*w].out.end(); ++u)
+          {
+            t.to = number[*u];
+            result.transitions.push_back(t);
+          }
+        }
+      }
+    }
+    if (index)
+      index->swap(number);
+  }
+private:
+  std::unordered_map<std::string, LabelIndex> m_index;
+};
+
 } // namespace lts
 
 template <>
@@ -54,6 +301,17 @@ public:
     void mark_scc() { label.div = 1; };
 };
 
+template <>
+struct Vertex<lts::ActionLabel>
+{
+public:
+    typedef lts::ActionLabel label_t;
+    label_t label;
+    VertexSet out; ///< Set of indices of vertices to which this vertex has an outgoing edge.
+    VertexSet in;  ///< Set of indices of vertices from which this vertex has an incoming edge.
+    void mark_scc() { label.div = 1; };
+};
+
 } // namespace graph
 
 #endif // __LTS_H
@@ -0,0 +1,142 @@
+#ifndef __MAPPING_H
+#define __MAPPING_H
+
+#include "vertex.h"
+#include "detail/reach.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace graph
+{
+
+  /**
+   * @brief Reading and writing of vertex mappings.
+   *
+   * A mapping records for every vertex of an original game the vertex of a
+   * reduced game that represents it, or impl::removed if it has no
+   * representative (for instance because it was unreachable).
+   *
+   * The text format contains one line per original vertex, holding the index of
+   * its representative or '-'. The binary format starts with the 6 bytes
+   * "PGMAP\1", one byte holding the width W (4 or 8) of the entries and a zero
+   * byte, followed by the number of entries as a little-endian 64-bit integer
+   * and the entries themselves as little-endian W-byte integers, where
+   * impl::removed is stored as all ones.
+   */
+  namespace mapping
+  {
+    static const char magic[] = "PGMAP\1";
+
+    inline void
+    put(std::ostream& s, unsigned long long value, size_t width)
+    {
+      char buf[8];
+      for (size_t i = 0; i < width; ++i, value >>= 8)
+        buf[i] = (char)(value & 0xff);
+      s.write(buf, width);
+    }
+
+    inline unsigned long long
+    get(std::istream& s, size_t width)
+    {
+      unsigned char buf[8];
+      s.read((char*)buf, width);
+      if (s.gcount() != (std::streamsize)width)
+        throw std::runtime_error("Unexpected end of binary mapping.");
+      unsigned long long value = 0;
+      for (size_t i = width; i > 0; --i)
+        value = (value << 8) | buf[i - 1];
+      return value;
+    }
+
+    /// @brief Writes @a m to @a s, in binary format if @a binary is set.
+    inline void
+    write(std::ostream& s, const std::vector<VertexIndex>& m, bool binary)
+    {
+      if (binary)
+      {
+        size_t width = 4;
+        for (size_t i = 0; i < m.size(); ++i)
+          if (m[i] != impl::removed and m[i] >= 0xffffffffULL)
+            width = 8;
+        s.write(magic, 6);
+        s.put((char)width);
+        s.put('\0');
+        put(s, m.size(), 8);
+        for (size_t i = 0; i < m.size(); ++i)
+          put(s, m[i] == impl::removed ? ~0ULL : m[i], width);
+      }
+      else
+      {
+        for (size_t i = 0; i < m.size(); ++i)
+        {
+          if (m[i] == impl::removed)
+            s << "-\n";
+          else
+            s << m[i] << '\n';
+        }
+      }
+      s << std::flush;
+    }
+
+    /// @brief Reads a mapping in either format from @a s into @a m.
+    inline void
+    read(std::istream& s, std::vector<VertexIndex>& m)
+    {
+      m.clear();
+      char header[8];
+      s.read(header, 8);
+      if (s.gcount() == 8 and std::memcmp(header, magic, 6) == 0)
+      {
+        size_t width = (unsigned char)header[6];
+        if (width != 4 and width != 8)
+          throw std::runtime_error("Invalid entry width in binary mapping.");
+        unsigned long long ones = width == 8 ? ~0ULL : 0xffffffffULL;
+        unsigned long long size = get(s, 8);
+        if (size > max_vertices)
+          throw std::runtime_error("Binary mapping is too large for this build (see GRAPH_32BIT_INDICES).");
+        m.resize(size);
+        for (size_t i = 0; i < m.size(); ++i)
+        {
+          unsigned long long value = get(s, width);
+          if (value != ones and value >= max_vertices)
+            throw std::runtime_error("Binary mapping entry is too large for this build (see GRAPH_32BIT_INDICES).");
+          m[i] = value == ones ? impl::removed : (VertexIndex)value;
+        }
+        return;
+      }
+      s.clear();
+      s.seekg(0, std::ios::beg);
+      std::string line;
+      while (std::getline(s, line))
+      {
+        if (line.empty())
+          continue;
+        if (line == "-")
+        {
+          m.push_back(impl::removed);
+          continue;
+        }
+        std::istringstream entry(line);
+        VertexIndex value;
+        entry >> value;
+        if (entry.fail())
+        {
+          std::stringstream msg;
+          msg << "Invalid entry for vertex " << m.size() << " in mapping: '"
+              << line << "'.";
+          throw std::runtime_error(msg.str());
+        }
+        m.push_back(value);
+      }
+    }
+  } // namespace mapping
+
+} // namespace graph
+
+#endif // __MAPPING_H
@@ -0,0 +1,281 @@
+#ifndef __MEMUSAGE_H
+#define __MEMUSAGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <sys/resource.h>
+
+#include "detail/pool.h"
+
+namespace graph
+{
+
+  /**
+   * @brief Accounting of the memory used by graphs and partitioners.
+   *
+   * The adjacency sets of graphs and the vertex lists of partitioners allocate
+   * through counting_allocator, which keeps the number of live bytes per
+   * category in a process-wide counter. The quotient is a graph, so the memory
+   * it takes shows up as growth of the adjacency category while it is built.
+   * If a limit is set (see set_limit()), an allocation that would take the
+   * counted bytes over the limit throws limit_exceeded instead, so that a tool
+   * can stop with a diagnostic rather than be killed by the operating system.
+   */
+  namespace memory
+  {
+    enum category_t
+    {
+      adjacency, ///< The in and out sets of the vertices of graphs.
+      partition, ///< The vertex lists of the blocks of partitioners.
+      categories
+    };
+
+    inline const char*
+    name(category_t c)
+    {
+      return c == adjacency ? "adjacency sets" : "partition lists";
+    }
+
+    inline std::atomic<long long>*
+    counters()
+    {
+      static std::atomic<long long> counters[categories] = {};
+      return counters;
+    }
+
+    inline std::atomic<unsigned long long>&
+    limit()
+    {
+      static std::atomic<unsigned long long> limit(0);
+      return limit;
+    }
+
+    /// @brief Returns the number of live bytes allocated for category @a c.
+    inline size_t
+    allocated(category_t c)
+    {
+      long long bytes = counters()[c].load(std::memory_order_relaxed);
+      return bytes > 0 ? (size_t)bytes : 0;
+    }
+
+    /// @brief Returns the number of live bytes allocated for all categories.
+    inline size_t
+    allocated()
+    {
+      size_t total = 0;
+      for (int c = 0; c < categories; ++c)
+        total += allocated((category_t)c);
+      return total;
+    }
+
+    /**
+     * @brief Reads the field @a key (e.g. "VmRSS:") of /proc/self/status, in bytes.
+     * @return 0 if the field is not available.
+     */
+    inline size_t
+    proc_status(const char* key)
+    {
+      size_t result = 0;
+      FILE* f = std::fopen("/proc/self/status", "r");
+      if (f == NULL)
+        return 0;
+      char line[256];
+      size_t len = std::strlen(key);
+      while (std::fgets(line, sizeof(line), f))
+      {
+        if (std::strncmp(line, key, len) == 0)
+        {
+          unsigned long long kb = 0;
+          if (std::sscanf(line + len, "%llu", &kb) == 1)
+            result = kb * 1024;
+          break;
+        }
+      }
+      std::fclose(f);
+      return result;
+    }
+
+    /// @brief Returns the resident set size of the process in bytes, or 0 if unknown.
+    inline size_t
+    resident()
+    {
+      return proc_status("VmRSS:");
+    }
+
+    /// @brief Returns the peak resident set size of the process in bytes.
+    inline size_t
+    peak()
+    {
+      size_t result = proc_status("VmHWM:");
+      if (result == 0)
+      {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+          result = (size_t)usage.ru_maxrss * 1024;
+      }
+      return result;
+    }
+
+    /// @brief Formats @a bytes in mebibytes.
+    inline std::string
+    mib(size_t bytes)
+    {
+      std::ostringstream s;
+      s.setf(std::ios::fixed);
+      s.precision(1);
+      s << bytes / 1048576.0 << " MiB";
+      return s.str();
+    }
+
+    /// @brief Describes the resident, peak and counted memory, for messages.
+    inline std::string
+    summary()
+    {
+      std::ostringstream s;
+      s << "resident " << mib(resident()) << ", peak " << mib(peak());
+      for (int c = 0; c < categories; ++c)
+        s << ", " << name((category_t)c) << " " << mib(allocated((category_t)c));
+#ifdef GRAPH_NODE_POOL
+      s << ", node pool " << mib(impl::NodePool::instance().reserved());
+#endif
+      return s.str();
+    }
+
+    /**
+     * @brief Exception thrown when the counted or resident memory exceeds the
+     *   limit set by set_limit().
+     *
+     * It derives from std::bad_alloc, as allocators are required to throw that,
+     * so that it passes handlers for std::runtime_error (such as those of the
+     * parsers) unchanged.
+     */
+    class limit_exceeded : public std::bad_alloc
+    {
+      public:
+        limit_exceeded(const std::string& where) :
+          m_message("Memory limit of " + mib(limit()) + " exceeded"
+              + (where.empty() ? "" : " during " + where) + " (" + summary() + ").")
+        {
+        }
+        const char*
+        what() const noexcept
+        {
+          return m_message.c_str();
+        }
+      private:
+        std::string m_message;
+    };
+
+    /**
+     * @brief Returns the memory of the node pool to the system if no node is in
+     *   use (see impl::NodePool::release). Must not be called while other
+     *   threads use graphs or partitioners.
+     */
+    inline void
+    release()
+    {
+#ifdef GRAPH_NODE_POOL
+      impl::NodePool::instance().release();
+#endif
+    }
+
+    /// @brief Limits the counted memory to @a bytes; 0 means no limit.
+    inline void
+    set_limit(size_t bytes)
+    {
+      limit() = bytes;
+    }
+
+    /**
+     * @brief Throws limit_exceeded if the resident set size exceeds the limit.
+     * @param where Describes what was being done, for the message.
+     */
+    inline void
+    check(const std::string& where)
+    {
+      size_t max = limit().load(std::memory_order_relaxed);
+      if (max != 0 and (allocated() > max or resident() > max))
+        throw limit_exceeded(where);
+    }
+
+    /**
+     * @class counting_allocator
+     * @brief Allocator that counts the live bytes it allocated in category @a C.
+     *
+     * If GRAPH_NODE_POOL is defined, single small objects (the nodes of sets and
+     * lists) come from impl::NodePool, which makes freeing them, and thus
+     * destroying a graph, much cheaper.
+     */
+    template <typename T, category_t C>
+    class counting_allocator
+    {
+      public:
+        typedef T value_type;
+        template <typename U> struct rebind { typedef counting_allocator<U, C> other; };
+
+        counting_allocator() {}
+        template <typename U>
+        counting_allocator(const counting_allocator<U, C>&) {}
+
+        T*
+        allocate(size_t n)
+        {
+          long long bytes = (long long)(n * sizeof(T));
+          counters()[C].fetch_add(bytes, std::memory_order_relaxed);
+          unsigned long long max = limit().load(std::memory_order_relaxed);
+          if (max != 0 and allocated() > max)
+          {
+            counters()[C].fetch_sub(bytes, std::memory_order_relaxed);
+            throw limit_exceeded("");
+          }
+          if (pooled(n))
+            return static_cast<T*>(impl::NodePool::instance().allocate(sizeof(T)));
+          return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        void
+        deallocate(T* p, size_t n)
+        {
+          counters()[C].fetch_sub((long long)(n * sizeof(T)), std::memory_order_relaxed);
+          if (pooled(n))
+            impl::NodePool::instance().deallocate(p, sizeof(T));
+          else
+            ::operator delete(p);
+        }
+      private:
+        /// Whether a request for @a n objects is served by impl::NodePool.
+        static bool
+        pooled(size_t n)
+        {
+#ifdef GRAPH_NODE_POOL
+          return n == 1 and sizeof(T) <= impl::NodePool::max_size and alignof(T) <= impl::NodePool::granularity;
+#else
+          return false;
+#endif
+        }
+    };
+
+    template <typename T, typename U, category_t C>
+    inline bool
+    operator==(const counting_allocator<T, C>&, const counting_allocator<U, C>&)
+    {
+      return true;
+    }
+
+    template <typename T, typename U, category_t C>
+    inline bool
+    operator!=(const counting_allocator<T, C>&, const counting_allocator<U, C>&)
+    {
+      return false;
+    }
+  } // namespace memory
+
+} // namespace graph
+
+#endif // __MEMUSAGE_H
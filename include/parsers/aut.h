@@ -1,157 +1,478 @@
+#ifndef __PARSERS_AUT_H
+#define __PARSERS_AUT_H
+
 #include "pg.h"
+#include "lts.h"
 #include "graph.h"
+#include "detail/parallel.h"
+#include "detail/reader.h"
+#include "detail/writer.h"
 
-#include <limits>
 #include <stdexcept>
 #include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace graph
 {
 
-  template<typename Vertex>
-  class Parser<Vertex, aut>
+  /**
+   * @brief Parser for labelled transition systems in Aldebaran format.
+   *
+   * The input is read ahead in large blocks on a background thread (see
+   * impl::InputReader). Every block is split into chunks of whole lines that are
+   * parsed concurrently, without copying. Each chunk collects its transitions
+   * and the distinct labels it encounters; afterwards the labels are interned in
+   * the label table of the transition system and the transitions are appended
+   * in order. Every transition must be on a line of its own.
+   *
+   * Action labels are either quoted (@c "a(1,2)") or unquoted (@c a(1,2)); in
+   * the latter case the label extends up to the last comma on the line. State
+   * indices are checked against the state count in the header.
+   */
+  template<>
+  class Parser<lts::TransitionSystem, aut>
   {
     public:
-      typedef graph::KripkeStructure<Vertex> graph_t;
-      Parser(graph_t& pg) :
-        m_pg(pg)
+      Parser(lts::TransitionSystem& lts) :
+        m_lts(lts), m_trans(0), m_wait(0)
       {
       }
+      /// @brief Reads a transition system from @a s, using up to @a threads threads.
       void
-      load(std::istream& s)
+      load(std::istream& s, size_t threads = 1)
       {
-        parse_header(s);
-        parse_body(s);
+        impl::InputReader in(s, 3, 16 << 20);
+        m_lts.transitions.clear();
+        parse_header(in);
+        m_lts.transitions.reserve(m_trans);
+        size_t line = in.line();
+        std::string carry; // Incomplete line at the end of the previous block.
+        const char* begin;
+        const char* end;
+        while (in.read_block(begin, end))
+        {
+          if (not carry.empty())
+          {
+            const char* eol = begin;
+            while (eol != end and *eol != '\n')
+              ++eol;
+            carry.append(begin, eol);
+            if (eol == end)
+              continue;
+            std::vector<Chunk> chunks(1);
+            chunks[0].begin = carry.data();
+            chunks[0].end = carry.data() + carry.size();
+            parse_chunk(chunks[0]);
+            line = merge(chunks, line);
+            begin = eol + 1;
+            carry.clear();
+          }
+          const char* last = end;
+          while (last != begin and last[-1] != '\n')
+            --last;
+          carry.assign(last, end);
+          parse_block(begin, last, threads, line);
+        }
+        if (not carry.empty())
+        {
+          std::vector<Chunk> chunks(1);
+          chunks[0].begin = carry.data();
+          chunks[0].end = carry.data() + carry.size();
+          parse_chunk(chunks[0]);
+          merge(chunks, line);
+        }
+        if (m_lts.transitions.size() > m_trans)
+        {
+          std::stringstream msg;
+          msg << "More transitions in file than specified in header (" << m_lts.transitions.size()
+              << " instead of " << m_trans << ").";
+          throw std::runtime_error(msg.str());
+        }
+        m_wait = in.wait_time();
       }
+      /**
+       * @brief Writes the transition system to @a s in Aldebaran format.
+       *
+       * Transitions are formatted into large buffers that are written to @a s on a
+       * background thread (see impl::AsyncWriter).
+       */
       void
       dump(std::ostream& s)
       {
-        throw std::runtime_error("Dumping .aut file is not supported.");
+        impl::AsyncWriter writer(s);
+        {
+          impl::OutputBuffer out(&writer);
+          out.put("des (");
+          out.put_uint(m_lts.initial);
+          out.put(',');
+          out.put_uint(m_lts.transitions.size());
+          out.put(',');
+          out.put_uint(m_lts.states);
+          out.put(")\n");
+          for (size_t i = 0; i < m_lts.transitions.size(); ++i)
+          {
+            const lts::Transition& t = m_lts.transitions[i];
+            const std::string& label = m_lts.labels[t.label];
+            out.put('(');
+            out.put_uint(t.from);
+            out.put(",\"", 2);
+            out.put(label.data(), label.size());
+            out.put("\",", 2);
+            out.put_uint(t.to);
+            out.put(")\n", 2);
+          }
+        }
+        writer.finish();
+        m_wait = writer.wait_time();
+      }
+      /// @brief Seconds that the last load or dump spent waiting for I/O.
+      double
+      wait_time() const
+      {
+        return m_wait;
       }
     private:
-      graph_t& m_pg;
+      /// @brief A label occurring in the input, which is not copied until it is interned.
+      struct LabelRef
+      {
+        const char* data;
+        size_t size;
+        bool operator==(const LabelRef& other) const
+        {
+          return size == other.size and std::equal(data, data + size, other.data);
+        }
+      };
+      struct LabelHash
+      {
+        size_t operator()(const LabelRef& label) const
+        {
+          size_t h = 14695981039346656037ULL;
+          for (size_t i = 0; i < label.size; ++i)
+            h = (h ^ (unsigned char)label.data[i]) * 1099511628211ULL;
+          return h;
+        }
+      };
+      typedef std::unordered_map<LabelRef, lts::LabelIndex, LabelHash> label_map_t;
+
+      /// @brief A range of whole lines that is parsed by a single thread.
+      struct Chunk
+      {
+        Chunk() : begin(NULL), end(NULL), lines(0), error_line(0) {}
+        const char* begin;
+        const char* end;
+        std::vector<lts::Transition> transitions; ///< Labels are indices into @c labels.
+        std::vector<LabelRef> labels;
+        size_t lines; ///< Number of lines in the chunk.
+        std::string error; ///< Description of the first error, if any.
+        size_t error_line; ///< Line of the error, relative to the chunk.
+      };
+
+      lts::TransitionSystem& m_lts;
       size_t m_trans;
-      size_t m_first;
+      double m_wait;
 
       void
-      parse_error(std::istream& s, const char* msg)
+      parse_error(impl::InputReader& in, const char* msg,
+          const std::string& consumed = std::string())
       {
-        s.clear();
         std::stringstream buf;
-        std::string token;
-        std::streampos p = s.tellg();
-        std::streamsize l = 0;
-        std::streampos b = 0;
-        s >> token;
-        s.seekg(0, std::ios::beg);
-        while (s.tellg() < p)
-        {
-          ++l;
-          b = s.tellg();
-          s.ignore(p, '\n');
-        }
-        buf << msg << " Error occurred while parsing '" << token
-            << "' at line " << l << ", column " << (p - b) << ".";
+        size_t line = in.line(), column = in.column() - consumed.size();
+        buf << msg << " Error occurred while parsing '" << consumed + in.read_token()
+            << "' at line " << line << ", column " << column << ".";
         throw std::runtime_error(buf.str());
       }
 
+      size_t
+      parse_uint(impl::InputReader& in, const char* msg)
+      {
+        unsigned long long value;
+        in.skip_space();
+        if (!in.read_uint(value) or value != (size_t)value)
+          parse_error(in, msg);
+        return value;
+      }
+
+      void
+      expect(impl::InputReader& in, char c, const char* msg)
+      {
+        in.skip_space();
+        if (in.peek() != c)
+          parse_error(in, msg);
+        in.get();
+      }
+
       void
-      parse_header(std::istream& s)
-      {
-        std::string firstword;
-        s >> std::skipws >> firstword;
-        if (firstword != "des")
-          parse_error(s, "Invalid header, expected 'des'.");
-        size_t states;
-        char c;
-        s >> c;
-        if (c != '(')
-          parse_error(s, "Invalid header, expected '(' after 'des'.");
-        s >> m_first;
-        if (s.fail())
-          parse_error(s, "Invalid header, could not parse initial state number.");
-        s >> c;
-        if (c != ',')
-          parse_error(s, "Invalid header, expected ',' after initial state number.");
-        s >> m_trans;
-        if (s.fail())
-          parse_error(s, "Invalid header, could not parse transition count.");
-        s >> c;
-        if (c != ',')
-          parse_error(s, "Invalid header, expected ',' after transition count.");
-        s >> states;
-        if (s.fail())
-          parse_error(s, "Invalid header, could not parse state count.");
-        s >> c;
-        if (c != ')')
-          parse_error(s, "Invalid header, expected ')' after state count.");
-        m_pg.resize(states);
+      parse_header(impl::InputReader& in)
+      {
+        in.skip_space();
+        std::string word = in.read_word();
+        if (word != "des")
+          parse_error(in, "Invalid header, expected 'des'.", word);
+        expect(in, '(', "Invalid header, expected '(' after 'des'.");
+        size_t initial = parse_uint(in, "Invalid header, could not parse initial state number.");
+        expect(in, ',', "Invalid header, expected ',' after initial state number.");
+        m_trans = parse_uint(in, "Invalid header, could not parse transition count.");
+        expect(in, ',', "Invalid header, expected ',' after transition count.");
+        m_lts.states = parse_uint(in, "Invalid header, could not parse state count.");
+        expect(in, ')', "Invalid header, expected ')' after state count.");
+        if (m_lts.states > max_vertices)
+          throw std::runtime_error("Invalid header, state count is too large for this build "
+                                   "(see GRAPH_32BIT_INDICES).");
+        if (m_lts.states and initial >= m_lts.states)
+          throw std::runtime_error("Invalid header, initial state is not a valid state index.");
+        m_lts.initial = initial;
       }
 
+      /// @brief Splits [begin, end) into chunks of whole lines and parses them concurrently.
       void
-      parse_trans(std::istream& s)
-      {
-        size_t from;
-        size_t to;
-
-        char c;
-        s >> c;
-        if (s.fail() && s.eof())
-          return;
-        if (c != '(')
-          parse_error(s, "Invalid transition, expected it to start with '('.");
-        s >> from;
-        if (s.fail())
-          parse_error(s, "Could not parse source state index.");
-        s >> c;
-        if (c != ',')
-          parse_error(s, "Invalid transition, expected ',' after source state.");
-        s >> c;
-        if (c != '"')
-          parse_error(s, "Invalid transition, label must start with '\"'.");
-        do
+      parse_block(const char* begin, const char* end, size_t threads, size_t& line)
+      {
+        const size_t min_chunk = 1 << 20;
+        size_t count = threads;
+        if ((size_t)(end - begin) / min_chunk < count)
+          count = (end - begin) / min_chunk;
+        if (count < 1)
+          count = 1;
+        std::vector<Chunk> chunks(count);
+        const char* p = begin;
+        for (size_t i = 0; i < count; ++i)
         {
-            s >> c;
+          chunks[i].begin = p;
+          p = i + 1 == count ? end : begin + (end - begin) * (i + 1) / count;
+          if (p < chunks[i].begin)
+            p = chunks[i].begin;
+          while (p != end and p[-1] != '\n')
+            ++p;
+          chunks[i].end = p;
         }
-        while (c != '"' && s.good());
-        s >> c;
-        if (c != ',')
-          parse_error(s, "Invalid transition, expected ',' after transition label.");
-        s >> to;
-        if (s.fail())
-          parse_error(s, "Could not parse target state index.");
-        s >> c;
-        if (c != ')')
-          parse_error(s, "Invalid transition, expected it to end with ')'.");
-
-        typename graph_t::vertex_t& vf = m_pg.vertex(from);
-        vf.out.insert(to);
-        typename graph_t::vertex_t& vt = m_pg.vertex(to);
-        vt.in.insert(from);
+        impl::parallel_for_each(count, threads, [&](size_t i)
+        {
+          parse_chunk(chunks[i]);
+        });
+        line = merge(chunks, line);
       }
 
+      /**
+       * @brief Interns the labels of @a chunks and appends their transitions.
+       * @param line The line at which the first chunk starts.
+       * @return The line following the last chunk.
+       */
+      size_t
+      merge(std::vector<Chunk>& chunks, size_t line)
+      {
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+          Chunk& chunk = chunks[i];
+          if (not chunk.error.empty())
+          {
+            std::stringstream msg;
+            msg << "Could not parse transition " << m_lts.transitions.size() + chunk.transitions.size()
+                << " at line " << line + chunk.error_line << ": " << chunk.error;
+            throw std::runtime_error(msg.str());
+          }
+          std::vector<lts::LabelIndex> index(chunk.labels.size());
+          for (size_t l = 0; l < chunk.labels.size(); ++l)
+            index[l] = m_lts.label_index(std::string(chunk.labels[l].data, chunk.labels[l].size));
+          for (size_t t = 0; t < chunk.transitions.size(); ++t)
+          {
+            lts::Transition& trans = chunk.transitions[t];
+            trans.label = index[trans.label];
+            m_lts.transitions.push_back(trans);
+          }
+          line += chunk.lines;
+        }
+        return line;
+      }
+
+      /// @brief Parses the lines in @a chunk, recording the first error instead of throwing it.
       void
-      parse_body(std::istream& s)
+      parse_chunk(Chunk& chunk)
       {
-        size_t n = 0;
-        while (!s.eof() && n < m_trans)
+        label_map_t labels;
+        const char* p = chunk.begin;
+        while (p != chunk.end)
         {
-          try
+          const char* eol = p;
+          while (eol != chunk.end and *eol != '\n')
+            ++eol;
+          const char* error = parse_line(chunk, labels, p, eol);
+          if (error)
           {
-            parse_trans(s);
-            ++n;
+            chunk.error_line = chunk.lines;
+            chunk.error = error;
+            return;
           }
-          catch (std::runtime_error& e)
+          ++chunk.lines;
+          p = eol == chunk.end ? eol : eol + 1;
+        }
+      }
+
+      static bool
+      is_space(char c)
+      {
+        return c == ' ' or c == '\t' or c == '\r';
+      }
+
+      static bool
+      parse_index(const char*& p, const char* end, VertexIndex& value)
+      {
+        if (p == end or *p < '0' or *p > '9')
+          return false;
+        value = 0;
+        for (; p != end and *p >= '0' and *p <= '9'; ++p)
+        {
+          VertexIndex next = value * 10 + (*p - '0');
+          if (next / 10 != value)
+            return false;
+          value = next;
+        }
+        return true;
+      }
+
+      /**
+       * @brief Parses the transition on the line [p, end), if any.
+       * @return NULL on success, or a description of the error.
+       */
+      const char*
+      parse_line(Chunk& chunk, label_map_t& labels, const char* p, const char* end)
+      {
+        while (p != end and is_space(*p))
+          ++p;
+        if (p == end)
+          return NULL;
+        lts::Transition trans;
+        if (*p++ != '(')
+          return "Invalid transition, expected it to start with '('.";
+        while (p != end and is_space(*p))
+          ++p;
+        if (!parse_index(p, end, trans.from))
+          return "Could not parse source state index.";
+        while (p != end and is_space(*p))
+          ++p;
+        if (p == end or *p++ != ',')
+          return "Invalid transition, expected ',' after source state.";
+        while (p != end and is_space(*p))
+          ++p;
+        LabelRef label;
+        if (p != end and *p == '"')
+        {
+          label.data = ++p;
+          while (p != end and *p != '"')
+            ++p;
+          if (p == end)
+            return "Invalid transition, label must end with '\"'.";
+          label.size = p++ - label.data;
+          while (p != end and is_space(*p))
+            ++p;
+          if (p == end or *p++ != ',')
+            return "Invalid transition, expected ',' after transition label.";
+        }
+        else
+        {
+          const char* comma = end;
+          while (comma != p and comma[-1] != ',')
+            --comma;
+          if (comma == p)
+            return "Invalid transition, expected ',' after transition label.";
+          label.data = p;
+          p = comma;
+          --comma;
+          while (comma != label.data and is_space(comma[-1]))
+            --comma;
+          label.size = comma - label.data;
+        }
+        while (p != end and is_space(*p))
+          ++p;
+        if (!parse_index(p, end, trans.to))
+          return "Could not parse target state index.";
+        while (p != end and is_space(*p))
+          ++p;
+        if (p == end or *p++ != ')')
+          return "Invalid transition, expected it to end with ')'.";
+        while (p != end and is_space(*p))
+          ++p;
+        if (p != end)
+          return "Invalid transition, expected a line break after ')'.";
+        if (trans.from >= m_lts.states or trans.to >= m_lts.states)
+          return "State index exceeds the number of states in the header.";
+        std::pair<label_map_t::iterator, bool> ins =
+          labels.insert(std::make_pair(label, (lts::LabelIndex)chunk.labels.size()));
+        if (ins.second)
+          chunk.labels.push_back(label);
+        trans.label = ins.first->second;
+        chunk.transitions.push_back(trans);
+        return NULL;
+      }
+  };
+
+  /**
+   * @brief Parser that reads an Aldebaran file into a Kripke structure.
+   *
+   * Action labels are dropped; the transitions become the edges of the graph.
+   * The initial state keeps its index, and is available from initial().
+   * Conversely, every edge is written as a transition labelled @c tau, and
+   * vertex 0 is written as the initial state.
+   */
+  template<typename Vertex>
+  class Parser<Vertex, aut>
+  {
+    public:
+      typedef graph::KripkeStructure<Vertex> graph_t;
+      Parser(graph_t& pg) :
+        m_pg(pg), m_wait(0), m_initial(0)
+      {
+      }
+      /// @brief Reads @a s, using up to @a threads threads (see Parser<lts::TransitionSystem, aut>).
+      void
+      load(std::istream& s, size_t threads = 1)
+      {
+        lts::TransitionSystem lts;
+        Parser<lts::TransitionSystem, aut> parser(lts);
+        parser.load(s, threads);
+        m_wait = parser.wait_time();
+        m_initial = lts.initial;
+        lts.to_graph(m_pg, threads);
+      }
+      void
+      dump(std::ostream& s)
+      {
+        lts::TransitionSystem lts;
+        lts::Transition t;
+        lts.states = m_pg.size();
+        t.label = lts.label_index("tau");
+        for (t.from = 0; t.from < m_pg.size(); ++t.from)
+        {
+          const VertexSet& out = m_pg.vertex(t.from).out;
+          for (VertexSet::const_iterator to = out.begin(); to != out.end(); ++to)
           {
-            std::stringstream msg;
-            msg << "Could not parse vertex " << n << ": " << e.what();
-            throw std::runtime_error(msg.str());
+            t.to = *to;
+            lts.transitions.push_back(t);
           }
         }
-        parse_trans(s);
-        if (!s.eof())
-          parse_error(s, "More transitions in file than specified in header.");
+        Parser<lts::TransitionSystem, aut> parser(lts);
+        parser.dump(s);
+        m_wait = parser.wait_time();
+      }
+      /// @brief Seconds that the last load or dump spent waiting for I/O.
+      double
+      wait_time() const
+      {
+        return m_wait;
       }
+      /// @brief The initial state given by the header of the last file read.
+      VertexIndex
+      initial() const
+      {
+        return m_initial;
+      }
+    private:
+      graph_t& m_pg;
+      double m_wait;
+      VertexIndex m_initial;
   };
 
 } // namespace graph
+
+#endif // __PARSERS_AUT_H
@@ -0,0 +1,230 @@
+#ifndef __PARSERS_PGBINARY_H
+#define __PARSERS_PGBINARY_H
+
+#include "pg.h"
+#include "graph.h"
+#include "detail/reader.h"
+#include "detail/writer.h"
+
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <sstream>
+
+namespace graph
+{
+
+  /**
+   * @brief The binary parity game format.
+   *
+   * A game starts with the 8 bytes "PGGAME\1\0", followed by the number of
+   * vertices. Then, for every vertex in order of increasing index, follow its
+   * priority, a byte holding its player (0 for even, 1 for odd), its number of
+   * successors and its successors in increasing order, of which the first is
+   * stored as is and every further one as the difference with its predecessor.
+   * All numbers except the player are stored in LEB128: 7 bits per byte, least
+   * significant first, with the high bit of every byte but the last set.
+   */
+  namespace pgbinary_format
+  {
+    static const char magic[] = "PGGAME\1";
+  }
+
+  /**
+   * @brief Writes a game in the binary format one vertex at a time.
+   *
+   * Vertices must be passed in order of increasing index, starting at 0. The
+   * output is written to the stream on a background thread.
+   */
+  template<>
+  class VertexWriter<pgbinary>
+  {
+    public:
+      VertexWriter(std::ostream& s) :
+        m_writer(s), m_out(&m_writer), m_size(0), m_next(0), m_edges(0)
+      {
+      }
+      /// @brief Starts a game with @a size vertices.
+      void
+      begin(size_t size)
+      {
+        m_size = size;
+        m_out.put(pgbinary_format::magic, 8);
+        m_out.put_varint(size);
+      }
+      /**
+       * @brief Writes vertex @a index with label @a label and the sorted
+       *   successors in [@a first, @a last).
+       */
+      template<typename Label, typename Iterator>
+      void
+      vertex(VertexIndex index, const Label& label, Iterator first, Iterator last)
+      {
+        assert(index == m_next);
+        ++m_next;
+        m_out.put_varint(label.prio);
+        m_out.put(label.player == pg::even ? '\0' : '\1');
+        size_t count = std::distance(first, last);
+        m_out.put_varint(count);
+        VertexIndex previous = 0;
+        for (; first != last; ++first)
+        {
+          m_out.put_varint(*first - previous);
+          previous = *first;
+        }
+        m_edges += count;
+      }
+      /// @brief Waits until the whole game has been written.
+      void
+      end()
+      {
+        m_out.flush();
+        m_writer.finish();
+      }
+      /// @brief Returns the number of vertices of the game.
+      size_t
+      size() const
+      {
+        return m_size;
+      }
+      /// @brief Returns the number of edges written.
+      size_t
+      edges() const
+      {
+        return m_edges;
+      }
+      /// @brief Seconds spent waiting for I/O.
+      double
+      wait_time() const
+      {
+        return m_writer.wait_time();
+      }
+    private:
+      impl::AsyncWriter m_writer;
+      impl::OutputBuffer m_out;
+      size_t m_size; ///< The number of vertices given to begin().
+      VertexIndex m_next; ///< The index of the next vertex.
+      size_t m_edges;
+  };
+
+  template<typename Vertex>
+  class Parser<Vertex, pgbinary>
+  {
+    public:
+      typedef graph::KripkeStructure<Vertex> graph_t;
+      Parser(graph_t& pg) :
+        m_pg(pg), m_wait(0)
+      {
+      }
+      /// @brief Returns whether @a s starts with a game in the binary format.
+      static bool
+      recognise(std::istream& s)
+      {
+        return s.peek() == pgbinary_format::magic[0];
+      }
+      /**
+       * @brief Reads a game in the binary format from @a s.
+       *
+       * The input is read ahead on a background thread (see impl::InputReader).
+       */
+      void
+      load(std::istream& s)
+      {
+        impl::InputReader in(s);
+        char header[8];
+        for (size_t i = 0; i < sizeof(header); ++i)
+          header[i] = (char)in.get();
+        if (std::memcmp(header, pgbinary_format::magic, 8) != 0)
+          throw std::runtime_error("Invalid header, this is not a binary parity game.");
+        unsigned long long size = get_varint(in);
+        if (size > max_vertices)
+          throw std::runtime_error("Binary parity game is too large for this build (see GRAPH_32BIT_INDICES).");
+        m_pg.resize(size);
+        for (size_t i = 0; i < m_pg.size(); ++i)
+        {
+          try
+          {
+            parse_vertex(in, i);
+          }
+          catch (std::runtime_error& e)
+          {
+            std::stringstream msg;
+            msg << "Could not parse vertex " << i << ": " << e.what();
+            throw std::runtime_error(msg.str());
+          }
+        }
+        m_wait = in.wait_time();
+      }
+      /**
+       * @brief Writes the game to @a s in the binary format (see
+       *   VertexWriter<pgbinary>).
+       */
+      void
+      dump(std::ostream& s)
+      {
+        VertexWriter<pgbinary> writer(s);
+        writer.begin(m_pg.size());
+        for (size_t i = 0; i < m_pg.size(); ++i)
+          writer.vertex(i, m_pg.vertex(i).label, m_pg.vertex(i).out.begin(), m_pg.vertex(i).out.end());
+        writer.end();
+        m_wait = writer.wait_time();
+      }
+      /// @brief Seconds that the last load or dump spent waiting for I/O.
+      double
+      wait_time() const
+      {
+        return m_wait;
+      }
+    private:
+      graph_t& m_pg;
+      double m_wait;
+
+      unsigned long long
+      get_varint(impl::InputReader& in)
+      {
+        unsigned long long value = 0;
+        for (size_t shift = 0; ; shift += 7)
+        {
+          int c = in.get();
+          if (c == impl::InputReader::eof)
+            throw std::runtime_error("Unexpected end of binary parity game.");
+          if (shift > 63 or (shift == 63 and (c & 0x7e)))
+            throw std::runtime_error("Number is too large.");
+          value |= (unsigned long long)(c & 0x7f) << shift;
+          if ((c & 0x80) == 0)
+            return value;
+        }
+      }
+
+      /*
+       * Successors are added at the end of the adjacency sets: they are stored
+       * in increasing order, and the vertices are read in increasing order.
+       */
+      void
+      parse_vertex(impl::InputReader& in, VertexIndex index)
+      {
+        typename graph_t::vertex_t& v = m_pg.vertex(index);
+        v.label.prio = get_varint(in);
+        int c = in.get();
+        if (c != 0 and c != 1)
+          throw std::runtime_error("Invalid player.");
+        v.label.player = c == 0 ? pg::even : pg::odd;
+        unsigned long long count = get_varint(in);
+        unsigned long long succ = 0;
+        for (unsigned long long i = 0; i < count; ++i)
+        {
+          unsigned long long delta = get_varint(in);
+          if ((i > 0 and delta == 0) or delta >= m_pg.size() - succ)
+            throw std::runtime_error("Invalid successor index.");
+          succ += delta;
+          v.out.insert(v.out.end(), succ);
+          VertexSet& in_set = m_pg.vertex(succ).in;
+          in_set.insert(in_set.end(), index);
+        }
+      }
+  };
+
+} // namespace graph
+
+#endif // __PARSERS_PGBINARY_H
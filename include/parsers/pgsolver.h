@@ -1,187 +1,342 @@
+#ifndef __PARSERS_PGSOLVER_H
+#define __PARSERS_PGSOLVER_H
+
 #include "pg.h"
 #include "graph.h"
+#include "detail/parallel.h"
+#include "detail/reader.h"
+#include "detail/writer.h"
 
 #include <cassert>
-#include <limits>
+#include <iterator>
 #include <stdexcept>
 #include <sstream>
 
 namespace graph
 {
 
+  /**
+   * @brief Writes a game in PGSolver format one vertex at a time.
+   *
+   * Vertices must be passed in order of increasing index. As in
+   * Parser<Vertex, pgsolver>::dump, the output is written to the stream on a
+   * background thread.
+   */
+  template<>
+  class VertexWriter<pgsolver>
+  {
+    public:
+      VertexWriter(std::ostream& s) :
+        m_writer(s), m_out(&m_writer), m_size(0), m_edges(0)
+      {
+      }
+      /// @brief Starts a game with @a size vertices.
+      void
+      begin(size_t size)
+      {
+        m_size = size;
+        if (size == 0)
+          return;
+        m_out.put("parity ");
+        m_out.put_uint(size - 1);
+        m_out.put(";\n");
+      }
+      /**
+       * @brief Writes vertex @a index with label @a label and the sorted
+       *   successors in [@a first, @a last).
+       */
+      template<typename Label, typename Iterator>
+      void
+      vertex(VertexIndex index, const Label& label, Iterator first, Iterator last)
+      {
+        put_vertex(m_out, index, label, first, last);
+        m_edges += std::distance(first, last);
+      }
+      /// @brief Waits until the whole game has been written.
+      void
+      end()
+      {
+        m_out.flush();
+        m_writer.finish();
+      }
+      /// @brief Returns the number of vertices of the game.
+      size_t
+      size() const
+      {
+        return m_size;
+      }
+      /// @brief Returns the number of edges written.
+      size_t
+      edges() const
+      {
+        return m_edges;
+      }
+      /// @brief Seconds spent waiting for I/O.
+      double
+      wait_time() const
+      {
+        return m_writer.wait_time();
+      }
+      /// @brief Formats a single vertex into @a out.
+      template<typename Label, typename Iterator>
+      static void
+      put_vertex(impl::OutputBuffer& out, VertexIndex index, const Label& label,
+          Iterator succ, Iterator last)
+      {
+        out.put_uint(index);
+        out.put(' ');
+        out.put_uint(label.prio);
+        out.put(label.player == pg::even ? " 0" : " 1", 2);
+        if (succ != last)
+        {
+          out.put(' ');
+          out.put_uint(*succ);
+          while (++succ != last)
+          {
+            out.put(',');
+            out.put_uint(*succ);
+          }
+        }
+        else
+          out.put(" \"no outgoing edges!\"");
+        out.put(";\n", 2);
+      }
+    private:
+      impl::AsyncWriter m_writer;
+      impl::OutputBuffer m_out;
+      size_t m_size; ///< The number of vertices given to begin().
+      size_t m_edges;
+  };
+
   template<typename Vertex>
   class Parser<Vertex, pgsolver>
   {
     public:
       typedef graph::KripkeStructure<Vertex> graph_t;
       Parser(graph_t& pg) :
-        m_pg(pg)
+        m_pg(pg), m_wait(0)
       {
       }
+      /**
+       * @brief Reads a game in PGSolver format from @a s.
+       *
+       * The input is read ahead on a background thread (see impl::InputReader),
+       * so reading and parsing overlap.
+       */
       void
       load(std::istream& s)
       {
-        parse_header(s);
-        parse_body(s);
+        impl::InputReader in(s);
+        parse_header(in);
+        parse_body(in);
+        m_wait = in.wait_time();
       }
+      /**
+       * @brief Writes the game to @a s in PGSolver format.
+       *
+       * Vertices are formatted into large buffers that are written to @a s on a
+       * background thread (see impl::AsyncWriter). If @a threads is larger than
+       * 1, consecutive chunks of vertices are formatted concurrently and written
+       * in order.
+       */
       void
-      dump(std::ostream& s)
+      dump(std::ostream& s, size_t threads = 1)
       {
         if (m_pg.empty())
           return;
-        s << "parity " << m_pg.size() - 1 << ";" << std::endl;
-        for (size_t i = 0; i < m_pg.size(); ++i)
+        impl::AsyncWriter writer(s);
         {
-          typename graph_t::vertex_t& v = m_pg.vertex(i);
-          s << i << ' ' << v.label.prio << ' '
-              << (v.label.player == pg::even ? '0' : '1');
-          VertexSet::const_iterator succ = v.out.begin();
-          if (succ != v.out.end())
-          {
-            s << ' ' << *succ;
-            while (++succ != v.out.end())
-            {
-              s << ',' << *succ;
-            }
-          }
+          impl::OutputBuffer out(&writer);
+          out.put("parity ");
+          out.put_uint(m_pg.size() - 1);
+          out.put(";\n");
+          if (threads <= 1)
+            dump_vertices(out, 0, m_pg.size());
           else
-            s << " \"no outgoing edges!\"";
-          s << ';' << std::endl;
+            dump_parallel(out, threads);
         }
+        writer.finish();
+        m_wait = writer.wait_time();
+      }
+      /// @brief Seconds that the last load or dump spent waiting for I/O.
+      double
+      wait_time() const
+      {
+        return m_wait;
       }
     private:
       graph_t& m_pg;
+      double m_wait;
+
       void
-      parse_error(std::istream& s, const char* msg)
+      dump_parallel(impl::OutputBuffer& out, size_t threads)
       {
-        s.clear();
-        std::stringstream buf;
-        std::string token;
-        std::streampos p = s.tellg();
-        std::streamsize l = 0;
-        std::streampos b = 0;
-        s >> token;
-        s.seekg(0, std::ios::beg);
-        while (s.tellg() < p)
+        const size_t chunk = 1 << 16;
+        std::vector<impl::OutputBuffer> buffers(threads, impl::OutputBuffer(NULL, 0));
+        for (size_t first = 0; first < m_pg.size(); first += threads * chunk)
         {
-          ++l;
-          b = s.tellg();
-          s.ignore(p, '\n');
+          impl::parallel_for_each(threads, threads, [&](size_t t)
+          {
+            size_t begin = first + t * chunk;
+            size_t end = begin + chunk < m_pg.size() ? begin + chunk : m_pg.size();
+            buffers[t].clear();
+            if (begin < end)
+              dump_vertices(buffers[t], begin, end);
+          });
+          for (size_t t = 0; t < threads; ++t)
+            out.put(buffers[t]);
         }
-        buf << msg << " Error occurred while parsing '" << token
-            << "' at line " << l << ", column " << (p - b) << ".";
-        throw std::runtime_error(buf.str());
       }
 
       void
-      parse_header(std::istream& s)
+      dump_vertices(impl::OutputBuffer& out, size_t begin, size_t end)
       {
-        std::string firstword;
-        s >> std::skipws >> firstword;
-        if (firstword == "parity")
+        for (size_t i = begin; i < end; ++i)
         {
-          size_t n;
-          char c;
-          s >> n;
-          m_pg.resize(n + 1);
-          s >> c;
-          if (c != ';')
-            parse_error(s, "Invalid header, expected semicolon.");
-
-          // mlsolver allows start keyword
-          std::string secondword;
-          s >> std::skipws >> secondword;
-          if(secondword == "start")
-          {
-            size_t start_n;
-            char c;
-            s >> start_n;
-            if(start_n != 0)
-              parse_error(s, "Invalid start vertex, expected 0.");
-            s >> c;
-            if (c != ';')
-              parse_error(s, "Invalid header, expected semicolon.");
-          }
-          else
-          {
-            s.seekg(-secondword.length(), std::ios::cur);
-            return;
-          }
-        }
-        else
-        {
-          assert(firstword != "start");
-          s.seekg(-firstword.length(), std::ios::cur);
-          return;
+          typename graph_t::vertex_t& v = m_pg.vertex(i);
+          VertexWriter<pgsolver>::put_vertex(out, i, v.label, v.out.begin(), v.out.end());
         }
       }
 
+      /**
+       * @brief Throws an error about the token at the current position, of which
+       *   @a consumed has already been read.
+       */
       void
-      parse_vertex(std::istream& s)
+      parse_error(impl::InputReader& in, const char* msg,
+          const std::string& consumed = std::string())
       {
-        size_t index;
-        size_t succ;
-        char c;
-        s >> index;
-        if (s.fail())
+        std::stringstream buf;
+        size_t line = in.line(), column = in.column() - consumed.size();
+        buf << msg << " Error occurred while parsing '" << consumed + in.read_token()
+            << "' at line " << line << ", column " << column << ".";
+        throw std::runtime_error(buf.str());
+      }
+
+      /// @brief Skips whitespace and returns the next character, without consuming it.
+      int
+      next_char(impl::InputReader& in)
+      {
+        in.skip_space();
+        return in.peek();
+      }
+
+      size_t
+      parse_uint(impl::InputReader& in, const char* msg)
+      {
+        unsigned long long value;
+        in.skip_space();
+        if (!in.read_uint(value))
+          parse_error(in, msg);
+        return value;
+      }
+
+      /// @brief Parses a vertex index, which must be smaller than max_vertices.
+      VertexIndex
+      parse_index(impl::InputReader& in, const char* msg)
+      {
+        size_t value = parse_uint(in, msg);
+        if (value >= max_vertices)
+          parse_error(in, "Vertex index is too large for this build (see GRAPH_32BIT_INDICES).");
+        return value;
+      }
+
+      void
+      expect(impl::InputReader& in, char c, const char* msg)
+      {
+        if (next_char(in) != c)
+          parse_error(in, msg);
+        in.get();
+      }
+
+      void
+      parse_header(impl::InputReader& in)
+      {
+        if (next_char(in) != 'p')
+        {
+          assert(in.peek() != 's');
+          return;
+        }
+        std::string word = in.read_word();
+        if (word != "parity")
+          parse_error(in, "Invalid header, expected 'parity'.", word);
+        m_pg.resize(parse_index(in, "Invalid header, could not parse vertex count.") + 1);
+        expect(in, ';', "Invalid header, expected semicolon.");
+
+        // mlsolver allows start keyword
+        if (next_char(in) == 's')
         {
-          if (s.eof())
-            return;
-          parse_error(s, "Could not parse vertex index.");
+          word = in.read_word();
+          if (word != "start")
+            parse_error(in, "Invalid header, expected 'start'.", word);
+          if (parse_uint(in, "Invalid start vertex, expected 0.") != 0)
+            parse_error(in, "Invalid start vertex, expected 0.");
+          expect(in, ';', "Invalid header, expected semicolon.");
         }
+      }
+
+      /// @brief Parses a vertex specification. Returns false at the end of the input.
+      bool
+      parse_vertex(impl::InputReader& in)
+      {
+        if (next_char(in) == impl::InputReader::eof)
+          return false;
+        VertexIndex index = parse_index(in, "Could not parse vertex index.");
         if (index >= m_pg.size())
           m_pg.resize(index + 1);
         typename graph_t::vertex_t& v = m_pg.vertex(index);
-        s >> v.label.prio;
-        if (s.fail())
-          parse_error(s, "Could not parse vertex priority.");
-        s >> c;
-        if (s.fail() or c < '0' or c > '1')
-          parse_error(s, "Could not parse vertex player.");
+        v.label.prio = parse_uint(in, "Could not parse vertex priority.");
+        int c = next_char(in);
+        if (c != '0' and c != '1')
+          parse_error(in, "Could not parse vertex player.");
+        in.get();
         v.label.player = c == '0' ? pg::even : pg::odd;
         do
         {
-          s >> succ;
-          if (s.fail())
-            parse_error(s, "Could not parse successor index.");
-          v.out.insert(succ);
+          // Resizing may move the vertices, so v cannot be used after this.
+          VertexIndex succ = parse_index(in, "Could not parse successor index.");
           if (succ >= m_pg.size())
             m_pg.resize(succ + 1);
+          m_pg.vertex(index).out.insert(succ);
           m_pg.vertex(succ).in.insert(index);
-          s >> c;
-          if (s.fail())
-            c = ';'; // Allow missing semicolon at end of file.
+          c = next_char(in);
+          if (c == ',')
+            in.get();
         }
         while (c == ',');
         if (c == '"')
         {
-          s.ignore(std::numeric_limits<std::streamsize>::max(), '"');
-          s >> c;
+          in.get();
+          in.skip_past('"');
+          c = next_char(in);
         }
-        if (c != ';')
-          parse_error(s, "Invalid vertex specification, expected semicolon.");
+        if (c == impl::InputReader::eof)
+          return true; // Allow missing semicolon at end of file.
+        expect(in, ';', "Invalid vertex specification, expected semicolon.");
+        return true;
       }
 
       void
-      parse_body(std::istream& s)
+      parse_body(impl::InputReader& in)
       {
         size_t n = 0, N = m_pg.size();
         N = N ? N : (size_t) -1;
-        while (!s.eof() && n != N)
+        try
         {
-          try
-          {
-            parse_vertex(s);
+          while (n != N && parse_vertex(in))
             ++n;
-          }
-          catch (std::runtime_error& e)
-          {
-            std::stringstream msg;
-            msg << "Could not parse vertex " << n << ": " << e.what();
-            throw std::runtime_error(msg.str());
-          }
+          if (m_pg.empty())
+            parse_error(in, "Expected a header or a vertex, found the end of the input.");
+        }
+        catch (std::runtime_error& e)
+        {
+          std::stringstream msg;
+          msg << "Could not parse vertex " << n << ": " << e.what();
+          throw std::runtime_error(msg.str());
         }
       }
   };
 
 } // namespace graph
+
+#endif // __PARSERS_PGSOLVER_H
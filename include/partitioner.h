@@ -5,47 +5,159 @@
 #include "graph.h"
 #include "vertex.h"
 #include "pg.h"
+#include "trace.h"
+#include "detail/parallel.h"
+#include <algorithm>
 #include <memory>
 #include <forward_list>
 #include <list>
 #include <vector>
-#include <cstdlib>
+#include <random>
+#include <stdexcept>
 #include <ctime>
 
+/*
+ * The most detailed cpplogging level at which the partitioners log. Messages at
+ * more detailed levels are removed at compile time, so that the debug output in
+ * the refinement loops costs nothing in production builds; progress messages at
+ * the verbose level remain selectable at run time. Set it through the CMake
+ * option GRAPH_PARTITIONER_LOG_LEVEL.
+ */
+#ifndef GRAPH_PARTITIONER_LOG_LEVEL
+#define GRAPH_PARTITIONER_LOG_LEVEL cpplogging::verbose
+#endif
+
+/// Like cpplog, but compiled out above GRAPH_PARTITIONER_LOG_LEVEL.
+#define graphlog(...) \
+  if (not graph::impl::log_compiled(__VA_ARGS__)) {} else cpplog(__VA_ARGS__)
+/// Like cpplogEnabled, but false at compile time above GRAPH_PARTITIONER_LOG_LEVEL.
+#define graphlogEnabled(...) \
+  (graph::impl::log_compiled(__VA_ARGS__) and cpplogEnabled(__VA_ARGS__))
+
 namespace graph
 {
 
-  typedef std::forward_list<graph::VertexIndex> VertexList; ///< List of vertices (used when VertexSet is too expensive).
+  namespace impl
+  {
+    /// Whether messages at @a level are compiled in (see GRAPH_PARTITIONER_LOG_LEVEL).
+    constexpr bool
+    log_compiled(cpplogging::log_level_t level, const char* = "")
+    {
+      return level <= GRAPH_PARTITIONER_LOG_LEVEL;
+    }
+  }
+
+  /// List of vertices (used when VertexSet is too expensive); its memory is counted (see graph::memory).
+  typedef std::forward_list<graph::VertexIndex,
+      memory::counting_allocator<graph::VertexIndex, memory::partition> > VertexList;
+
+  /**
+   * @brief Counters that describe the work done by a partitioner.
+   *
+   * The counters are updated at block granularity (or once per vertex in
+   * block_t::update()), so keeping them costs next to nothing.
+   */
+  struct PartitionerStatistics
+  {
+    PartitionerStatistics() :
+      rounds(0), self_split_attempts(0), self_splits(0), splitter_split_attempts(0),
+      splitter_splits(0), refinements(0), vertices_moved(0), update_edges(0),
+      attractor_visits(0)
+    {
+    }
+    size_t rounds; ///< Iterations of the main loop of Partitioner::partition().
+    size_t self_split_attempts; ///< Attempts to split a block by itself.
+    size_t self_splits; ///< Attempts to split a block by itself that succeeded.
+    size_t splitter_split_attempts; ///< Attempts to split a block using another block.
+    size_t splitter_splits; ///< Attempts to split a block using another block that succeeded.
+    size_t refinements; ///< Blocks created by Partitioner::refine().
+    size_t vertices_moved; ///< Vertices that Partitioner::refine() moved to another block.
+    size_t update_edges; ///< Edges incident to the vertices visited by block_t::update().
+    size_t attractor_visits; ///< Vertices added to attractor sets.
+  };
 
   class PartitionerTraits
   {
     public:
-      template<typename Block, typename Label>
-  struct vertex_t : public graph::Vertex<Label>
+      /**
+       * @brief Per-vertex state of a partitioner, stored as one array per field.
+       *
+       * The state is owned by the partitioner rather than stored in the vertices,
+       * so the graph is only read while partitioning, and the loops that only
+       * look at blocks and marks do not pull adjacency sets into the cache.
+       */
+      template<typename Block>
+  struct state_t
+  {
+    public:
+      void
+      resize(size_t size)
+      {
+        block.assign(size, NULL);
+        visitbit.assign(size, false);
+        pos.assign(size, false);
+        statistics = PartitionerStatistics();
+      }
+      void
+      visit(VertexIndex v)
+      {
+        visitbit[v] = true;
+      }
+      void
+      clear(VertexIndex v)
+      {
+        visitbit[v] = false;
+      }
+      bool
+      visited(VertexIndex v) const
+      {
+        return visitbit[v];
+      }
+      std::vector<Block*> block; ///< The block to which each vertex belongs.
+      std::vector<unsigned char> visitbit; ///< Tag used by the partition refinement algorithms.
+      std::vector<unsigned char> pos; ///< Marks the vertices that refine() moves to a new block.
+      PartitionerStatistics statistics; ///< Kept here so that blocks can update it.
+  };
+
+      /**
+       * @brief Per-vertex state of the partitioners for games, which count
+       *   visits instead of marking them.
+       */
+      template<typename Block>
+  struct counter_state_t
   {
     public:
-      vertex_t() :
-    graph::Vertex<Label>(), block(NULL), visitbit(false), pos(false)
+      void
+      resize(size_t size)
       {
+        block.assign(size, NULL);
+        visitcounter.assign(size, 0);
+        external.assign(size, 0);
+        div.assign(size, 0);
+        pos.assign(size, false);
+        statistics = PartitionerStatistics();
       }
-      Block *block; ///< The block to which @c v belongs.
-      unsigned char visitbit :1; ///< Tag used by the partition refinement algorithms.
-      unsigned char pos :1;
       void
-      visit()
+      visit(VertexIndex v)
       {
-        visitbit = true;
+        ++visitcounter[v];
       }
       void
-      clear()
+      clear(VertexIndex v)
       {
-        visitbit = false;
+        visitcounter[v] = 0;
       }
       bool
-      visited() const
+      visited(VertexIndex v) const
       {
-        return visitbit;
+        return visitcounter[v] > 0;
       }
+      std::vector<Block*> block; ///< The block to which each vertex belongs.
+      std::vector<VertexIndex> visitcounter; ///< Tag used by the partition refinement algorithms.
+      std::vector<VertexIndex> external; ///< Number of edges (or blocks) outside the vertex's block.
+      std::vector<unsigned char> div; ///< The players that may be divergent in the vertex's block.
+      std::vector<unsigned char> pos; ///< Marks the vertices that refine() moves to a new block.
+      PartitionerStatistics statistics; ///< Kept here so that blocks can update it.
   };
 
       /**
@@ -92,11 +204,12 @@ namespace graph
   typedef typename partitioner_traits::block_t block_t;
   typedef typename partitioner_traits::blocklist_t blocklist_t;
   typedef typename partitioner_traits::graph_t graph_t;
+  typedef typename partitioner_traits::state_t state_t;
 
-  Partitioner(graph_t& pg) :
-      m_pg(pg)
+  Partitioner(const graph_t& pg) :
+      m_pg(pg), m_random(time(NULL) ^ (size_t)this), m_release(NULL), m_threads(1)
   {
-    srand(time(NULL));
+    m_watch[0] = m_watch[1] = impl::removed;
   }
   /**
    * @brief Finds the coarsest partition for @a pg. If quotient is given, then
@@ -105,43 +218,51 @@ namespace graph
    * @param pg The parity game to partition.
    * @param quotient A reference to the parity game that will contain the quotient.
    *   The quotient is not stored if this parameter is @c NULL.
+   * @details If stop_when_separated() was called, refinement stops as soon as
+   *   a round ends with the watched vertices in different blocks.
    */
   void
   partition(graph_t* quotient = NULL)
   {
-    bool found_splitter = true;
-    block_t* B1 = NULL;
     std::list<block_t*> splittable;
     typename blocklist_t::reverse_iterator B2;
+    m_state.resize(m_pg.size());
     create_initial_partition();
     cpplog(cpplogging::verbose, "partitioner")
       << "Created " << m_blocks.size() << " initial blocks.\n";
-    if(cpplogEnabled(cpplogging::debug1, "partitioner"))
+    bool found_splitter = not separated();
+    if(graphlogEnabled(cpplogging::debug1, "partitioner"))
     {
     for(typename blocklist_t::iterator B = m_blocks.begin(); B != m_blocks.end(); ++B)
     {
-      cpplog(cpplogging::debug1, "partitioner")
+      graphlog(cpplogging::debug1, "partitioner")
         << "  block #" << B->index << " now contains the following vertices: " << std::endl;
       for(VertexList::const_iterator i = B->vertices.begin(); i != B->vertices.end(); ++i)
       {
                 if(i != B->vertices.begin()) {
-                    cpplog(cpplogging::debug1, "partitioner") << ", ";
+                    graphlog(cpplogging::debug1, "partitioner") << ", ";
                 }
-        cpplog(cpplogging::debug1, "partitioner") << *i;
+        graphlog(cpplogging::debug1, "partitioner") << *i;
       }
-      cpplog(cpplogging::debug1, "partitioner") << std::endl;
+      graphlog(cpplogging::debug1, "partitioner") << std::endl;
     }
-    cpplog(cpplogging::debug1, "partitioner") << std::endl;
+    graphlog(cpplogging::debug1, "partitioner") << std::endl;
     }
     while (found_splitter)
     {
+      trace::span round("partition round");
+      ++m_state.statistics.rounds;
       /* First, try to find a block that can be split by itself. */
       for (B2 = m_blocks.rbegin(); B2 != m_blocks.rend(); ++B2)
       {
         if (!B2->divstable)
           {
+            ++m_state.statistics.self_split_attempts;
             if (split(&(*B2)))
+            {
+              ++m_state.statistics.self_splits;
               splittable.push_back(&(*B2));
+            }
             else
               B2->divstable = true;
           }
@@ -161,21 +282,24 @@ namespace graph
         for (VertexList::const_iterator src = B2->incoming.begin();
       src != B2->incoming.end(); ++src)
         {
-    vertex_t& v = m_pg.vertex(*src);
-    v.visit();
-    v.block->visited = false;
+    m_state.visit(*src);
+    m_state.block[*src]->visited = false;
         }
         for (VertexList::const_iterator src = B2->incoming.begin();
       src != B2->incoming.end(); ++src)
         {
-    vertex_t& v = m_pg.vertex(*src);
-    if ((!v.block->visited) and (v.block != &(*B2)))
+    block_t* B1 = m_state.block[*src];
+    if ((!B1->visited) and (B1 != &(*B2)))
     {
-      if (split(v.block, &(*B2)))
-        splittable.push_back(v.block);
-      v.block->visited = true;
+      ++m_state.statistics.splitter_split_attempts;
+      if (split(B1, &(*B2)))
+      {
+        ++m_state.statistics.splitter_splits;
+        splittable.push_back(B1);
+      }
+      B1->visited = true;
     }
-    v.clear();
+    m_state.clear(*src);
         }
         B2++->stable = splittable.empty();
       }
@@ -198,12 +322,145 @@ namespace graph
     B->stable = false;
       }
       splittable.clear();
+      if (separated())
+        found_splitter = false;
+    }
+    if (separated())
+    {
+      cpplog(cpplogging::verbose, "partitioner")
+        << "Stopped refinement with " << m_blocks.size()
+        << " blocks: the watched vertices are in different blocks.\n";
+      return;
     }
     cpplog(cpplogging::verbose, "partitioner")
       << "Quotienting " << m_blocks.size() << " blocks.\n";
     if (quotient)
       this->quotient(*quotient);
   }
+  /**
+   * @brief Stores the quotient of the graph modulo the partition computed by
+   *   partition() in @a result.
+   * @details Equivalent to passing @a result to partition(), but lets the caller
+   *   time quotienting separately from refinement.
+   */
+  void
+  store_quotient(graph_t& result)
+  {
+    quotient(result);
+  }
+  /**
+   * @brief Like store_quotient(graph_t&), but frees the edges of @a input, which
+   *   must be the graph that was partitioned, and the vertex lists of the
+   *   blocks while the quotient is built.
+   * @details The quotient of a block only depends on the edges of the
+   *   vertices in that block, so they are freed as soon as the block has been
+   *   handled; the input and the quotient are therefore never both fully in
+   *   memory. Afterwards, @a input has no edges, and only block_index() and
+   *   statistics() can be used.
+   */
+  void
+  store_quotient(graph_t& result, graph_t& input)
+  {
+    if (&input != &m_pg)
+      throw std::logic_error("store_quotient must be given the partitioned graph.");
+    m_release = &input;
+    quotient(result);
+    m_release = NULL;
+  }
+  /**
+   * @brief Passes the quotient of the graph modulo the partition computed by
+   *   partition() to @a sink, one vertex at a time, instead of storing it.
+   * @details @a sink must provide begin(@e size), which is called first with
+   *   the number of vertices of the quotient, vertex(@e index, @e label,
+   *   @e first, @e last), which is then called for every vertex in order of
+   *   increasing index with the range of its sorted successors, and end(),
+   *   which is called last (see for instance VertexWriter). The quotient
+   *   is the one that store_quotient() would store, so block 0 contains
+   *   vertex 0 and block_index() can be used afterwards.
+   */
+  template <typename Sink>
+  void
+  stream_quotient(Sink& sink)
+  {
+    write_quotient(sink);
+  }
+  /**
+   * @brief Like stream_quotient(Sink&), but frees the edges of @a input while
+   *   the quotient is written (see store_quotient(graph_t&, graph_t&)).
+   */
+  template <typename Sink>
+  void
+  stream_quotient(Sink& sink, graph_t& input)
+  {
+    if (&input != &m_pg)
+      throw std::logic_error("stream_quotient must be given the partitioned graph.");
+    m_release = &input;
+    write_quotient(sink);
+    m_release = NULL;
+  }
+  /**
+   * @brief Returns the index of the block that contains vertex @a v.
+   * @details After partition() has stored a quotient, this is the index of the
+   *   vertex in the quotient that represents @a v.
+   */
+  size_t
+  block_index(VertexIndex v) const
+  {
+    return m_state.block[v]->index;
+  }
+  /**
+   * @brief Makes partition() stop refining as soon as vertices @a v and @a w
+   *   are in different blocks, which proves that they are not equivalent.
+   * @details If partition() stops early, its partition is not stable, so no
+   *   quotient may be computed from it; block_index() still tells which
+   *   vertices were separated.
+   */
+  void
+  stop_when_separated(VertexIndex v, VertexIndex w)
+  {
+    m_watch[0] = v;
+    m_watch[1] = w;
+  }
+  /// @brief Sets the number of threads that quotient() may use.
+  void
+  set_threads(size_t threads)
+  {
+    m_threads = threads;
+  }
+  /// @brief Returns the graph that is partitioned.
+  const graph_t&
+  graph() const
+  {
+    return m_pg;
+  }
+  /// @brief Returns the counters of the last call to partition().
+  const PartitionerStatistics&
+  statistics() const
+  {
+    return m_state.statistics;
+  }
+  /**
+   * @brief Returns the number of blocks of every size, in powers of two.
+   * @details Entry @e i is the number of blocks with at least 2^@e i and
+   *   less than 2^(@e i + 1) vertices.
+   */
+  std::vector<size_t>
+  block_size_histogram() const
+  {
+    std::vector<size_t> histogram;
+    for (typename blocklist_t::const_iterator B = m_blocks.begin(); B != m_blocks.end(); ++B)
+    {
+      size_t size = 0, bucket = 0;
+      for (VertexList::const_iterator v = B->vertices.begin(); v != B->vertices.end(); ++v)
+        ++size;
+      while ((size_t)2 << bucket <= size)
+        ++bucket;
+      if (histogram.size() <= bucket)
+        histogram.resize(bucket + 1, 0);
+      ++histogram[bucket];
+    }
+    return histogram;
+  }
   /**
    * @brief Dump a textual representation of the partitioning to s.
    * @details For example, if the original parity game contained 5 nodes, the
@@ -247,7 +504,7 @@ namespace graph
   {
     // m_split contains a subset of B
     size_t sB = 0, sC = 0;
-    m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+    m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
     block_t& C = m_blocks.back();
     B.vertices.push_front(0);
     C.vertices.push_front(0);
@@ -258,12 +515,11 @@ namespace graph
     VertexList::iterator iC = C.vertices.begin();
     while (iB != B.vertices.end())
     {
-      vertex_t& v = m_pg.vertex(*iB);
-      if (v.pos)
+      if (m_state.pos[*iB])
       {
         ++sC;
-        v.block = &C;
-        v.pos = false;
+        m_state.block[*iB] = &C;
+        m_state.pos[*iB] = false;
         iC = C.vertices.insert_after(iC, *iB);
         iB = B.vertices.erase_after(pB);
       }
@@ -275,15 +531,19 @@ namespace graph
     }
     C.vertices.pop_front();
     B.vertices.pop_front();
+    ++m_state.statistics.refinements;
 
-    if ((float)rand() / RAND_MAX < 0.5f)
+    if (m_random() - m_random.min() < (m_random.max() - m_random.min()) / 2)
     {
+      m_state.statistics.vertices_moved += sB;
       B.vertices.swap(C.vertices);
       for (iB = B.vertices.begin(); iB != B.vertices.end(); ++iB)
-        m_pg.vertex(*iB).block = &B;
+        m_state.block[*iB] = &B;
       for (iC = C.vertices.begin(); iC != C.vertices.end(); ++iC)
-        m_pg.vertex(*iC).block = &C;
+        m_state.block[*iC] = &C;
     }
+    else
+      m_state.statistics.vertices_moved += sC;
 
     bool result = false;
     if (B.update(&C))
@@ -291,34 +551,33 @@ namespace graph
     if (C.update(&B))
       result = true;
 
-    cpplog(cpplogging::debug, "partitioner")
+    graphlog(cpplogging::debug, "partitioner")
       << "Created block #" << C.index << " from #" << B.index << ": " << sC << " nodes (left "
-      << sB << "). Prio: "
-      << m_pg.vertex(C.vertices.front()).label.prio << std::endl;
+      << sB << ")." << std::endl;
 
-    if(cpplogEnabled(cpplogging::debug1, "partitioner"))
+    if(graphlogEnabled(cpplogging::debug1, "partitioner"))
     {
-      cpplog(cpplogging::debug1, "partitioner")
+      graphlog(cpplogging::debug1, "partitioner")
     << "  block #" << B.index << " now contains the following vertices: " << std::endl;
       for(VertexList::const_iterator i = B.vertices.begin(); i != B.vertices.end(); ++i)
       {
           if(i != B.vertices.begin()) {
-            cpplog(cpplogging::debug1, "partitioner") << ", ";
+            graphlog(cpplogging::debug1, "partitioner") << ", ";
           }
-        cpplog(cpplogging::debug1, "partitioner") << *i;
+        graphlog(cpplogging::debug1, "partitioner") << *i;
       }
-      cpplog(cpplogging::debug1, "partitioner") << std::endl;
-      cpplog(cpplogging::debug1, "partitioner")
+      graphlog(cpplogging::debug1, "partitioner") << std::endl;
+      graphlog(cpplogging::debug1, "partitioner")
     << "  block #" << C.index << " now contains the following vertices: " << std::endl;
       for(VertexList::const_iterator i = C.vertices.begin(); i != B.vertices.end(); ++i)
       {
           if(i != C.vertices.begin())
           {
-            cpplog(cpplogging::debug1, "partitioner") << ", ";
+            graphlog(cpplogging::debug1, "partitioner") << ", ";
           }
-        cpplog(cpplogging::debug1, "partitioner") << *i;
+        graphlog(cpplogging::debug1, "partitioner") << *i;
       }
-      cpplog(cpplogging::debug1, "partitioner") << std::endl;
+      graphlog(cpplogging::debug1, "partitioner") << std::endl;
     }
 
     return result;
@@ -349,19 +608,186 @@ namespace graph
   split(const block_t* B1, const block_t* B2) = 0;
   virtual bool
   split(const block_t* B1) = 0;
+  /// Self-loops of a vertex in the quotient, as returned by describe().
+  enum { no_self_loop = 0, self_loop_out = 1, self_loop_in = 2, self_loop = 3 };
+
+  /// @brief Returns whether the vertices given to stop_when_separated() are in different blocks.
+  bool
+  separated() const
+  {
+    return m_watch[0] != impl::removed and m_state.block[m_watch[0]] != m_state.block[m_watch[1]];
+  }
+
+  /**
+   * @brief Sets @a label to the label of the vertex that represents block @a B
+   *   in the quotient, and returns which self-loops that vertex has (a
+   *   combination of self_loop_out and self_loop_in).
+   * @details Edges between different blocks are added to the quotient by
+   *   quotient() and stream_quotient(). This is called concurrently for
+   *   different blocks, and may only read the vertices in @a B.
+   */
+  virtual int
+  describe(const block_t& B, typename vertex_t::label_t& label) = 0;
+  /**
+   * @brief Called by quotient_edges() for every block once it has been
+   *   handled.
+   * @details Frees the edges of the vertices in @a B and the lists of @a B if
+   *   store_quotient(graph_t&, graph_t&) or stream_quotient(Sink&, graph_t&)
+   *   asked for it.
+   */
+  void
+  release_block(block_t& B)
+  {
+    if (m_release == NULL)
+      return;
+    for (VertexList::const_iterator v = B.vertices.begin(); v != B.vertices.end(); ++v)
+    {
+      VertexSet().swap(m_release->vertex(*v).out);
+      VertexSet().swap(m_release->vertex(*v).in);
+    }
+    VertexList().swap(B.vertices);
+    VertexList().swap(B.incoming);
+  }
+
   /**
    * @brief Writes the quotient induced by the current partition to @a g.
-   * @pre m_vertices represents the coarsest partition that the partition()
-   *   method could obtain.
-   * @post A quotiented version of the parity game represented by m_vertices
-   *   has been stored in @a g.
-   * @param g The ParityGame object in which to store the quotient.
+   * @details See quotient_edges(); the adjacency sets of the vertices of @a g
+   *   are filled from the sorted lists it computes, independently for every
+   *   vertex on m_threads threads.
    */
-  virtual void
-  quotient(graph_t& quotient) = 0;
+  void
+  quotient(graph_t& g)
+  {
+    quotient_t q;
+    quotient_edges(q);
+    size_t n = q.labels.size();
+    g.resize(n);
+    impl::parallel_for(n, m_threads, [&](size_t begin, size_t end)
+    {
+      for (size_t v = begin; v < end; ++v)
+      {
+        vertex_t& repr = g.vertex(v);
+        repr.label = q.labels[v];
+        for (size_t i = q.first[v]; i < q.first[v + 1]; ++i)
+          repr.out.insert(repr.out.end(), q.succ[i]);
+        for (size_t i = 0; i < q.pred[v].size(); ++i)
+          repr.in.insert(repr.in.end(), q.pred[v][i]);
+        std::vector<VertexIndex>().swap(q.pred[v]);
+      }
+    });
+  }
+
+  /**
+   * @brief Passes the quotient to @a sink in order of increasing index (see
+   *   stream_quotient()).
+   */
+  template <typename Sink>
+  void
+  write_quotient(Sink& sink)
+  {
+    quotient_t q;
+    quotient_edges(q);
+    std::vector<std::vector<VertexIndex> >().swap(q.pred);
+    size_t n = q.labels.size();
+    sink.begin(n);
+    for (size_t v = 0; v < n; ++v)
+      sink.vertex(v, q.labels[v], q.succ.begin() + q.first[v], q.succ.begin() + q.first[v + 1]);
+    sink.end();
+  }
+
+  /// @brief The quotient in compact form (see quotient_edges()).
+  struct quotient_t
+  {
+    std::vector<typename vertex_t::label_t> labels; ///< The label of every vertex.
+    std::vector<std::vector<VertexIndex> > pred; ///< The sorted predecessors of every vertex.
+    std::vector<size_t> first; ///< Vertex v has successors succ[first[v]] up to succ[first[v + 1]].
+    std::vector<VertexIndex> succ; ///< The sorted successors of every vertex, one after the other.
+  };
+
+  /**
+   * @brief Computes the quotient induced by the current partition in @a q, on
+   *   m_threads threads.
+   * @details Every block becomes the vertex with the block's index, labelled
+   *   by describe(), and block 0 is made to contain vertex 0. This is done in
+   *   two phases. First, the indices of the blocks with an edge into a block
+   *   are collected from its @c incoming list, sorted and deduplicated,
+   *   independently for every block. These lists are then transposed to
+   *   obtain the successors of every block, in order of increasing index.
+   */
+  void
+  quotient_edges(quotient_t& q)
+  {
+    if (m_pg.size() == 0)
+    {
+      q.first.assign(1, 0);
+      return;
+    }
+    size_t n = m_blocks.size();
+
+    // Make sure node 0 is in block 0
+    size_t oldblock = m_state.block[0]->index;
+    m_state.block[0]->index = 0;
+    m_blocks.front().index = oldblock;
+
+    std::vector<block_t*> blocks(n);
+    for (typename blocklist_t::iterator B = m_blocks.begin(); B != m_blocks.end(); ++B)
+      blocks[B->index] = &(*B);
+
+    q.labels.resize(n);
+    q.pred.resize(n);
+    std::vector<char> self(n); // Whether a block is its own successor.
+    impl::parallel_for(n, m_threads, [&](size_t begin, size_t end)
+    {
+      for (size_t b = begin; b < end; ++b)
+      {
+        block_t& B = *blocks[b];
+        std::vector<VertexIndex>& p = q.pred[b];
+        for (VertexList::const_iterator sv = B.incoming.begin(); sv != B.incoming.end(); ++sv)
+          p.push_back(m_state.block[*sv]->index);
+        std::sort(p.begin(), p.end());
+        p.erase(std::unique(p.begin(), p.end()), p.end());
+        std::vector<VertexIndex>::iterator own = std::lower_bound(p.begin(), p.end(), b);
+        bool internal = own != p.end() and *own == b;
+        int loops = describe(B, q.labels[b]);
+        self[b] = internal or (loops & self_loop_out);
+        if (not internal and (loops & self_loop_in))
+          p.insert(own, b);
+        release_block(B);
+      }
+    });
+
+    // Block dst is a successor of block src iff src is in pred[dst]; listing
+    // the successors in order of dst keeps every list sorted.
+    q.first.assign(n + 1, 0);
+    for (size_t dst = 0; dst < n; ++dst)
+    {
+      for (size_t i = 0; i < q.pred[dst].size(); ++i)
+        if (q.pred[dst][i] != dst)
+          ++q.first[q.pred[dst][i] + 1];
+      if (self[dst])
+        ++q.first[dst + 1];
+    }
+    for (size_t src = 0; src < n; ++src)
+      q.first[src + 1] += q.first[src];
+    q.succ.resize(q.first[n]);
+    std::vector<size_t> next(q.first.begin(), q.first.end() - 1);
+    for (size_t dst = 0; dst < n; ++dst)
+    {
+      for (size_t i = 0; i < q.pred[dst].size(); ++i)
+        if (q.pred[dst][i] != dst)
+          q.succ[next[q.pred[dst][i]]++] = dst;
+      if (self[dst])
+        q.succ[next[dst]++] = dst;
+    }
+  }
 
   blocklist_t m_blocks;
-  graph_t& m_pg;
+  const graph_t& m_pg;
+  state_t m_state; ///< The per-vertex state, indexed by vertex.
+  std::minstd_rand m_random; ///< Private generator, so partitioners can run concurrently.
+  graph_t* m_release; ///< The graph whose edges quotient() frees, if any (see store_quotient).
+  size_t m_threads; ///< The number of threads quotient() may use.
+  VertexIndex m_watch[2]; ///< The vertices given to stop_when_separated(), if any.
     };
 
 } // namespace graph
@@ -0,0 +1,105 @@
+#ifndef __SOLUTION_H
+#define __SOLUTION_H
+
+#include "pg.h"
+#include "detail/reach.h"
+
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace graph {
+namespace pg {
+
+/**
+ * @brief Winners and winning strategies of the vertices of a parity game.
+ *
+ * Solutions are read and written in the PGSolver solution format:
+ * @verbatim
+   paritysol 2;
+   0 1 2;
+   1 0;
+   2 1 0; @endverbatim
+ * Every line after the (optional) header holds a vertex, its winner, and
+ * optionally the successor chosen by the winner's strategy.
+ */
+struct Solution
+{
+  enum { unknown = 2 }; ///< Winner of a vertex that is not in the solution.
+
+  std::vector<unsigned char> winner; ///< Player winning each vertex, or @c unknown.
+  std::vector<VertexIndex> strategy; ///< Chosen successor of each vertex, or impl::removed.
+
+  /// @brief Reads a solution from @a s.
+  void
+  load(std::istream& s)
+  {
+    winner.clear();
+    strategy.clear();
+    std::string line;
+    size_t lineno = 0;
+    while (std::getline(s, line))
+    {
+      ++lineno;
+      std::string::size_type end = line.find(';');
+      if (end != std::string::npos)
+        line.erase(end);
+      std::istringstream entry(line);
+      std::string first;
+      if (!(entry >> first) or first == "paritysol")
+        continue;
+      std::istringstream index(first);
+      VertexIndex v;
+      int w;
+      index >> v;
+      entry >> w;
+      if (index.fail() or entry.fail() or (w != even and w != odd))
+      {
+        std::stringstream msg;
+        msg << "Invalid solution entry at line " << lineno << ": '" << line << "'.";
+        throw std::runtime_error(msg.str());
+      }
+      if (v >= winner.size())
+      {
+        winner.resize(v + 1, unknown);
+        strategy.resize(v + 1, impl::removed);
+      }
+      winner[v] = (unsigned char)w;
+      VertexIndex succ;
+      if (entry >> succ)
+        strategy[v] = succ;
+    }
+  }
+
+  /// @brief Writes the solution to @a s.
+  void
+  dump(std::ostream& s) const
+  {
+    if (winner.empty())
+      return;
+    s << "paritysol " << winner.size() - 1 << ";\n";
+    for (size_t v = 0; v < winner.size(); ++v)
+      dump_vertex(s, v, winner[v], strategy[v]);
+    s << std::flush;
+  }
+
+  /// @brief Writes the solution line for a single vertex to @a s.
+  static void
+  dump_vertex(std::ostream& s, VertexIndex v, unsigned char w, VertexIndex succ)
+  {
+    if (w == unknown)
+      return;
+    s << v << ' ' << (int)w;
+    if (succ != impl::removed)
+      s << ' ' << succ;
+    s << ";\n";
+  }
+};
+
+} // namespace pg
+} // namespace graph
+
+#endif // __SOLUTION_H
@@ -13,13 +13,15 @@ class StutteringTraits
 public:
   struct block_t;
 
-  typedef graph::PartitionerTraits::vertex_t<block_t, Label> vertex_t;
+  typedef graph::Vertex<Label> vertex_t;
   typedef graph::KripkeStructure<vertex_t> graph_t;
+  typedef PartitionerTraits::state_t<block_t> state_t;
   typedef VertexList vertexlist_t;
 
   struct block_t : public PartitionerTraits::block_t
   {
-    block_t(graph_t& pg, size_t index) : PartitionerTraits::block_t(index), pg(pg) {}
+    block_t(const graph_t& pg, state_t& state, size_t index) :
+      PartitionerTraits::block_t(index), pg(pg), state(state) {}
     bool update(PartitionerTraits::block_t* has_edge_from=NULL)
     {
       bool result = false;
@@ -28,19 +30,20 @@ public:
       bottom.clear();
       for (VertexList::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
       {
-        vertex_t& v = pg.vertex(*i);
+        const vertex_t& v = pg.vertex(*i);
+        state.statistics.update_edges += v.in.size() + v.out.size();
         for (VertexSet::const_iterator src = v.in.begin(); src != v.in.end(); ++src)
         {
-          if (pg.vertex(*src).block != this)
+          if (state.block[*src] != this)
           {
             incoming.push_front(*src);
-            result = result or (pg.vertex(*src).block == has_edge_from);
+            result = result or (state.block[*src] == has_edge_from);
           }
         }
         bool is_bottom = true;
         for (VertexSet::const_iterator dst = v.out.begin(); dst != v.out.end(); ++dst)
         {
-          if (this == pg.vertex(*dst).block)
+          if (this == state.block[*dst])
           {
             is_bottom = false;
             break;
@@ -51,7 +54,8 @@ public:
       }
       return result;
     }
-    graph_t& pg; ///< The partition(er) to which the block belongs.
+    const graph_t& pg; ///< The graph that is being partitioned.
+    state_t& state; ///< The per-vertex state of the partitioner.
     vertexlist_t bottom; ///< A list of vertices in the block that have only outgoing edges to other blocks.
   };
 
@@ -72,9 +76,10 @@ public:
   typedef typename Partitioner<StutteringTraits<Label> >::blocklist_t blocklist_t;
   using Partitioner<StutteringTraits<Label> >::m_blocks;
   using Partitioner<StutteringTraits<Label> >::m_pg;
-  StutteringPartitioner(graph_t& pg) : Partitioner<StutteringTraits<Label> >(pg) {}
+  using Partitioner<StutteringTraits<Label> >::m_state;
+  StutteringPartitioner(const graph_t& pg) : Partitioner<StutteringTraits<Label> >(pg) {}
   const blocklist_t blocks() const { return m_blocks; }
-  block_t& newblock() { m_blocks.push_back(block_t(m_pg, m_blocks.size())); return m_blocks.back(); }
+  block_t& newblock() { m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size())); return m_blocks.back(); }
 protected:
   /**
    * @brief Creates the initial partition.
@@ -89,13 +94,13 @@ protected:
     // Assign blocks to vertices
     for (size_t i = m_pg.size() - 1; i != (size_t)-1; --i)
     {
-      vertex_t& v = m_pg.vertex(i);
+      const vertex_t& v = m_pg.vertex(i);
       typename pmap::iterator B = blocks.find(v.label);
       if (B == blocks.end())
       {
         B = blocks.insert(std::make_pair(v.label, &newblock())).first;
       }
-      v.block = B->second;
+      m_state.block[i] = B->second;
       B->second->vertices.push_front(i);
     }
 
@@ -125,30 +130,28 @@ protected:
   {
     bool all_bottoms_visited = true;
     for (VertexList::const_iterator v = B1->bottom.begin(); all_bottoms_visited and v != B1->bottom.end(); ++v)
-      all_bottoms_visited = all_bottoms_visited and m_pg.vertex(*v).visited();
+      all_bottoms_visited = all_bottoms_visited and m_state.visited(*v);
     if (all_bottoms_visited)
       return false;
 
     VertexList todo;
     for (VertexList::const_iterator vi = B1->vertices.begin(); vi != B1->vertices.end(); ++vi)
     {
-      vertex_t& v = m_pg.vertex(*vi);
-      if (v.visited())
+      if (m_state.visited(*vi))
       {
-        v.pos = true;
+        m_state.pos[*vi] = true;
         todo.push_front(*vi);
       }
     }
     while (not todo.empty())
     {
-      vertex_t& v = m_pg.vertex(todo.front());
+      const vertex_t& v = m_pg.vertex(todo.front());
       todo.pop_front();
       for (VertexSet::const_iterator pred = v.in.begin(); pred != v.in.end(); ++pred)
       {
-        vertex_t& p = m_pg.vertex(*pred);
-        if (p.block == B1 and not p.pos)
+        if (m_state.block[*pred] == B1 and not m_state.pos[*pred])
         {
-          p.pos = true;
+          m_state.pos[*pred] = true;
           todo.push_front(*pred);
         }
       }
@@ -156,42 +159,17 @@ protected:
     return true;
   }
   /**
-   * @brief Quotients the parity game and stores the result in @a g.
+   * @brief Labels the vertex that represents @a B in the quotient (see
+   *   Partitioner::describe).
    *
    * Quotienting is done by viewing each block as a vertex. The priority and player of a
    * block are defined as the priority and player of the first vertex in the block's
    * @c vertices member.
-   * @param g ParityGame in which the quotient is stored.
    */
-  void quotient(graph_t& quotient)
+  int describe(const block_t& B, typename vertex_t::label_t& label)
   {
-    quotient.resize(m_blocks.size());
-    size_t src, dst, vc = 1;
-
-    // Make sure node 0 is in block 0
-    size_t oldblock = m_pg.vertex(0).block->index;
-    m_pg.vertex(0).block->index = 0;
-    m_blocks.front().index = oldblock;
-
-    for (typename blocklist_t::const_iterator B = m_blocks.begin(); B != m_blocks.end(); ++B, ++vc)
-    {
-      dst = B->index;
-      VertexList::const_iterator v = B->vertices.begin();
-      vertex_t& repr = quotient.vertex(dst);
-      repr.label = m_pg.vertex(*v).label;
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv != B->incoming.end(); ++sv)
-        quotient.vertex(m_pg.vertex(*sv).block->index).clear();
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv != B->incoming.end(); ++sv)
-      {
-        src = m_pg.vertex(*sv).block->index;
-        if (not quotient.vertex(src).visited())
-        {
-          quotient.vertex(src).out.insert(dst);
-          repr.in.insert(src);
-          quotient.vertex(src).visit();
-        }
-      }
-    }
+    label = m_pg.vertex(B.vertices.front()).label;
+    return this->no_self_loop;
   }
 };
 
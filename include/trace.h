@@ -0,0 +1,195 @@
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace graph
+{
+
+  /**
+   * @brief Recording of a timeline of begin and end events, per thread.
+   *
+   * Tracing is off until enable() is called; until then, begin(), end() and
+   * span cost a single relaxed atomic load. Every thread appends its events to
+   * a buffer of its own, so recording takes no locks except when a thread
+   * records its first event. write() produces the Chrome trace event format,
+   * which can be opened in chrome://tracing or ui.perfetto.dev; it must only be
+   * called once the threads that recorded events have finished.
+   */
+  namespace trace
+  {
+    struct event_t
+    {
+      event_t(const std::string& name, char phase, double time) :
+        name(name), phase(phase), time(time) {}
+      std::string name;
+      char phase; ///< 'B' for the begin and 'E' for the end of a span.
+      double time; ///< Microseconds since tracing was enabled.
+    };
+
+    /// @brief The events recorded by a single thread.
+    struct buffer_t
+    {
+      buffer_t(size_t tid) : tid(tid) {}
+      size_t tid; ///< Threads are numbered in the order of their first event.
+      std::vector<event_t> events;
+    };
+
+    class Recorder
+    {
+      public:
+        static Recorder&
+        instance()
+        {
+          static Recorder recorder;
+          return recorder;
+        }
+        bool
+        enabled() const
+        {
+          return m_enabled.load(std::memory_order_relaxed);
+        }
+        void
+        enable()
+        {
+          m_start = std::chrono::steady_clock::now();
+          m_enabled = true;
+        }
+        void
+        record(const std::string& name, char phase)
+        {
+          std::chrono::duration<double, std::micro> time =
+              std::chrono::steady_clock::now() - m_start;
+          local().events.push_back(event_t(name, phase, time.count()));
+        }
+        void
+        write(std::ostream& s)
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          s << "{\"traceEvents\":[";
+          bool first = true;
+          for (size_t b = 0; b < m_buffers.size(); ++b)
+          {
+            const buffer_t& buffer = *m_buffers[b];
+            s << (first ? "\n" : ",\n")
+              << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+              << buffer.tid << ",\"args\":{\"name\":\"thread " << buffer.tid << "\"}}";
+            first = false;
+            for (size_t i = 0; i < buffer.events.size(); ++i)
+            {
+              const event_t& e = buffer.events[i];
+              s << ",\n{\"name\":\"";
+              escape(s, e.name);
+              s << "\",\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":" << buffer.tid
+                << ",\"ts\":" << std::fixed << e.time << '}';
+              s.unsetf(std::ios::floatfield);
+            }
+          }
+          s << "\n]}\n" << std::flush;
+        }
+      private:
+        std::atomic<bool> m_enabled;
+        std::chrono::steady_clock::time_point m_start;
+        std::mutex m_mutex; ///< Protects m_buffers.
+        std::vector<std::unique_ptr<buffer_t> > m_buffers;
+
+        Recorder() : m_enabled(false) {}
+
+        /// @brief Returns the buffer of the calling thread.
+        buffer_t&
+        local()
+        {
+          static thread_local buffer_t* buffer = NULL;
+          if (buffer == NULL)
+          {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_buffers.push_back(std::unique_ptr<buffer_t>(new buffer_t(m_buffers.size() + 1)));
+            buffer = m_buffers.back().get();
+          }
+          return *buffer;
+        }
+
+        static void
+        escape(std::ostream& s, const std::string& name)
+        {
+          for (std::string::const_iterator c = name.begin(); c != name.end(); ++c)
+          {
+            if (*c == '"' or *c == '\\')
+              s << '\\' << *c;
+            else if ((unsigned char)*c >= 0x20)
+              s << *c;
+          }
+        }
+    };
+
+    /// @brief Returns whether events are being recorded.
+    inline bool
+    enabled()
+    {
+      return Recorder::instance().enabled();
+    }
+
+    /// @brief Starts recording events.
+    inline void
+    enable()
+    {
+      Recorder::instance().enable();
+    }
+
+    /// @brief Records the beginning of span @a name in the calling thread.
+    inline void
+    begin(const std::string& name)
+    {
+      if (enabled())
+        Recorder::instance().record(name, 'B');
+    }
+
+    /// @brief Records the end of span @a name in the calling thread.
+    inline void
+    end(const std::string& name)
+    {
+      if (enabled())
+        Recorder::instance().record(name, 'E');
+    }
+
+    /// @brief Writes the recorded events to @a s (see graph::trace).
+    inline void
+    write(std::ostream& s)
+    {
+      Recorder::instance().write(s);
+    }
+
+    /**
+     * @class span
+     * @brief Records a span from its construction to its destruction.
+     */
+    class span
+    {
+      public:
+        span(const char* name) : m_name(name), m_active(enabled())
+        {
+          if (m_active)
+            Recorder::instance().record(m_name, 'B');
+        }
+        ~span()
+        {
+          if (m_active)
+            Recorder::instance().record(m_name, 'E');
+        }
+      private:
+        const char* m_name;
+        bool m_active; ///< Whether the beginning was recorded.
+        span(const span&);
+        span& operator=(const span&);
+    };
+  } // namespace trace
+
+} // namespace graph
+
+#endif // __TRACE_H
@@ -1,13 +1,32 @@
 #ifndef __GRAPH_VERTEX_H
 #define __GRAPH_VERTEX_H
 
+#include "memusage.h"
+
 #include <set>
 #include <cstring>
+#include <cstdint>
+#include <functional>
 
 namespace graph {
 
+/*
+ * Vertex indices are 64 bits wide by default. Building with
+ * GRAPH_32BIT_INDICES halves the size of adjacency sets, vertex lists and the
+ * per-vertex bookkeeping of the partitioners, at the cost of limiting graphs to
+ * 2^32 - 1 vertices (the parsers reject larger ones).
+ */
+#ifdef GRAPH_32BIT_INDICES
+typedef uint32_t VertexIndex;
+#else
 typedef size_t VertexIndex;
-typedef std::set<VertexIndex> VertexSet; ///< Type used to store adjacency lists.
+#endif
+/// Type used to store adjacency lists; its memory is counted (see graph::memory).
+typedef std::set<VertexIndex, std::less<VertexIndex>,
+    memory::counting_allocator<VertexIndex, memory::adjacency> > VertexSet;
+
+/// The largest number of vertices that a graph can have (the largest index is reserved).
+const unsigned long long max_vertices = (VertexIndex)-1;
 
 /**
  * @brief Structure containing a vertex.
@@ -25,7 +25,8 @@ public:
       blocklist_t;
   using Partitioner<GovernedStutteringTraits<Label> >::m_blocks;
   using Partitioner<GovernedStutteringTraits<Label> >::m_pg;
-  ParadisePartitioner(graph_t& pg) :
+  using Partitioner<GovernedStutteringTraits<Label> >::m_state;
+  ParadisePartitioner(const graph_t& pg) :
     graph::Partitioner<GovernedStutteringTraits<Label> >(pg) {
   }
   const blocklist_t blocks() const {
@@ -33,20 +34,24 @@ public:
   }
   block_t&
   newblock() {
-    m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+    m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
     return m_blocks.back();
   }
 
   void partition(graph_t* quotient = NULL) {
+    m_state.resize(m_pg.size());
     create_initial_partition();
     size_t n = m_blocks.size();
     cpplog(cpplogging::verbose, "partitioner") << "Created " << n << " initial blocks.\n";
 
     // Split into paradise / non-paradise blocks
+    ++m_state.statistics.rounds;
     for (typename blocklist_t::iterator B = m_blocks.begin(); n > 0; ++B, --n)
     {
+      ++m_state.statistics.self_split_attempts;
       if (split(&*B))
       {
+        ++m_state.statistics.self_splits;
         this->refine(*B);
       }
     }
@@ -56,16 +61,18 @@ public:
     size_t l = n;
     for (typename blocklist_t::iterator B = m_blocks.begin(); n > 0; ++B, --n)
     {
-      if (m_pg.vertex(B->vertices.front()).div != 3)
+      if (m_state.div[B->vertices.front()] != 3)
       {
         // This is not a paradise: split into one block per node
         VertexList::iterator v = B->vertices.begin(), prev = v++;
         while (v != B->vertices.end())
         {
-          m_blocks.push_back(block_t(m_pg, l++));
+          m_blocks.push_back(block_t(m_pg, m_state, l++));
           block_t &C = m_blocks.back();
           C.vertices.push_front(*v);
-          m_pg.vertex(*v).block = &C;
+          m_state.block[*v] = &C;
+          ++m_state.statistics.refinements;
+          ++m_state.statistics.vertices_moved;
           v = B->vertices.erase_after(prev);
           C.update();
         }
@@ -92,15 +99,15 @@ protected:
     // Assign blocks to vertices
     for (size_t i = m_pg.size() - 1; i != (size_t) -1; --i)
     {
-      vertex_t &v = m_pg.vertex(i);
+      const vertex_t &v = m_pg.vertex(i);
       typename pmap::iterator B = blocks.find(v.label.prio % 2);
       if (B == blocks.end())
       {
-        m_blocks.push_back(block_t(m_pg, m_blocks.size()));
+        m_blocks.push_back(block_t(m_pg, m_state, m_blocks.size()));
         B = blocks.insert(
             std::make_pair(v.label.prio % 2, &m_blocks.back())).first;
       }
-      v.block = B->second;
+      m_state.block[i] = B->second;
       B->second->vertices.push_front(i);
     }
 
@@ -122,65 +129,37 @@ protected:
 
     for (VertexList::const_iterator vi = B->vertices.begin(); vi
         != B->vertices.end(); ++vi)
-    m_pg.vertex(*vi).div = 3;
+    m_state.div[*vi] = 3;
 
     result = split(B, m_pg.vertex(B->vertices.front()).label.prio % 2 == 0 ? odd : even);
 
     for (VertexList::const_iterator vi = B->vertices.begin(); vi
         != B->vertices.end(); ++vi)
-    m_pg.vertex(*vi).clear();
+    m_state.clear(*vi);
 
     return result;
   }
   /**
-   * @brief Quotients the parity game and stores the result in @a g.
+   * @brief Labels the vertex that represents @a B in the quotient (see
+   *   Partitioner::describe).
    *
    * Quotienting is done by viewing each block as a vertex. The priority and player of a
    * block are defined as the priority and player of the first vertex in the block's
-   * @c vertices member.
-   * @param g ParityGame in which the quotient is stored.
+   * @c vertices member; blocks that are divergent for both players belong to the
+   * player that wins their priority. Such blocks, and blocks whose first vertex
+   * has a self-loop, get a self-loop.
    */
-  void
-  quotient(graph_t& g)
+  int
+  describe(const block_t& B, typename vertex_t::label_t& label)
   {
-    g.resize(m_blocks.size());
-
-    for (VertexIndex i = 0; i < m_pg.size(); ++i)
-      m_pg.vertex(i).visitcounter = 0;
-
-    // Make sure node 0 is in block 0
-    size_t oldblock = m_pg.vertex(0).block->index;
-    m_pg.vertex(0).block->index = 0;
-    m_blocks.front().index = oldblock;
-
-    size_t src, dst, vc = 1;
-    for (typename blocklist_t::const_iterator B = m_blocks.begin(); B != m_blocks.end(); ++B, ++vc)
-    {
-      dst = B->index;
-      VertexIndex v;
-      vertex_t& repr = g.vertex(dst);
-      vertex_t& orig = m_pg.vertex(B->vertices.front());
-
-      repr.label.player = (orig.div == 3) ? (((orig.label.prio % 2) == 0) ? even : odd ) : orig.label.player;
-      repr.label.prio = orig.label.prio;
-      // if (divergent(&(*B), (Player)repr.label.player))
-      if (orig.div == 3 or orig.out.count(B->vertices.front()))
-      {
-        repr.out.insert(dst);
-        repr.in.insert(dst);
-      }
-      for (VertexList::const_iterator sv = B->incoming.begin(); sv
-          != B->incoming.end(); ++sv)
-      {
-        src = m_pg.vertex(*sv).block->index;
-        if (m_pg.vertex(src).visitcounter != vc)
-        {
-          g.vertex(src).out.insert(dst);
-          repr.in.insert(src);
-          m_pg.vertex(src).visitcounter = vc;
-        }
-      }
-    }
+    const vertex_t& orig = m_pg.vertex(B.vertices.front());
+    unsigned char div = m_state.div[B.vertices.front()];
+
+    label.player = (div == 3) ? (Player)(((orig.label.prio % 2) == 0) ? even : odd) : (Player)orig.label.player;
+    label.prio = orig.label.prio;
+    if (div == 3 or orig.out.count(B.vertices.front()))
+      return this->self_loop;
+    return this->no_self_loop;
   }
 private:
   /**
@@ -200,10 +179,10 @@ private:
     for (VertexList::const_iterator vi = B->vertices.begin(); vi
         != B->vertices.end(); ++vi)
     {
-      vertex_t& v = m_pg.vertex(*vi);
-      v.visitcounter = v.external;
-      if (v.visitcounter == v.out.size() or (v.label.player == p
-              and v.visited()))
+      const vertex_t& v = m_pg.vertex(*vi);
+      m_state.visitcounter[*vi] = m_state.external[*vi];
+      if (m_state.visitcounter[*vi] == v.out.size() or (v.label.player == p
+              and m_state.visited(*vi)))
       todo.push_front(*vi);
     }
 
@@ -213,7 +192,7 @@ private:
     {
       for (VertexList::const_iterator vi = B->vertices.begin(); vi
           != B->vertices.end(); ++vi)
-      m_pg.vertex(*vi).pos = false;
+      m_state.pos[*vi] = false;
       return false;
     }
     return true;
@@ -234,28 +213,28 @@ private:
     size_t result = 0;
 
     for (VertexList::const_iterator it = todo.begin(); it != todo.end(); ++it)
-    m_pg.vertex(*it).pos = true;
+    m_state.pos[*it] = true;
 
     while (not todo.empty())
     {
       size_t i = todo.front();
-      vertex_t& v = m_pg.vertex(i);
+      const vertex_t& v = m_pg.vertex(i);
       todo.pop_front();
 
-      v.div &= ~opponent_bm;
+      m_state.div[i] &= ~opponent_bm;
       ++result;
 
       for (VertexSet::const_iterator pred = v.in.begin(); pred
           != v.in.end(); ++pred)
       {
-        vertex_t& w = m_pg.vertex(*pred);
-        if (w.block == B and not w.pos)
+        if (m_state.block[*pred] == B and not m_state.pos[*pred])
         {
-          w.visit();
-          if (w.visitcounter == w.out.size() or (w.label.player == p
-                  and w.visited()))
+          const vertex_t& w = m_pg.vertex(*pred);
+          m_state.visit(*pred);
+          if (m_state.visitcounter[*pred] == w.out.size() or (w.label.player == p
+                  and m_state.visited(*pred)))
           {
-            w.pos = true;
+            m_state.pos[*pred] = true;
             todo.push_front(*pred);
           }
         }
@@ -263,7 +242,8 @@ private:
     }
     for (VertexList::const_iterator it = B->vertices.begin(); it
         != B->vertices.end(); ++it)
-    m_pg.vertex(*it).clear();
+    m_state.clear(*it);
+    m_state.statistics.attractor_visits += result;
     return result;
   }
 };
@@ -1,6 +1,8 @@
 #include "parsers/aut.h"
 #include "detail/scc.h"
+#include "detail/writer.h"
 #include "lts.h"
+#include "streams.h"
 
 #include "cppcli/input_output_tool.h"
 #include "cpplogging/logger.h"
@@ -8,16 +10,22 @@
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 /**
- * @class pgconvert
- * @brief Tool class that can execute parity game reductions.
+ * @class autscc
+ * @brief Tool class that dumps the strongly connected components of a .aut file.
  */
 class autscc : public tools::input_output_tool
 {
   private:
-    std::auto_ptr<std::ifstream> m_ifstream;
-    std::auto_ptr<std::ofstream> m_ofstream;
+    size_t m_threads; ///< The number of threads given by --threads.
+    bool m_nontrivial; ///< Only write non-trivial SCCs.
+    bool m_statistics; ///< Report the sizes of the SCCs.
+    std::string m_dag_filename; ///< The file to write the condensation to, if any.
+    InputFile m_input;
+    OutputFile m_output;
+    OutputFile m_dag;
   public:
     typedef graph::KripkeStructure<graph::Vertex<graph::lts::DivLabel> > graph_t;
     autscc() :
@@ -29,13 +37,18 @@ class autscc : public tools::input_output_tool
             // Tool summary:
             "Dumps SCCs within a .aut file.",
             // Tool description:
-            "Dumps SCCs within a .aut file.",
+            "Dumps the SCCs within a .aut file, one line per SCC, listing the "
+            "states of the SCC. SCCs are written in reverse topological order. "
+            "Optionally, the condensation of the transition system (the graph of "
+            "its SCCs) is written in .aut format.",
             // Known issues:
-            "None")
+            "None"),
+        m_threads(1), m_nontrivial(false), m_statistics(false)
     {
     }
 
-    void
+    /// @brief Reads the transition system in @a s into @a graph, and returns its initial state.
+    graph::VertexIndex
     load(graph_t& graph, std::istream& s)
     {
       cpplog(cpplogging::verbose)
@@ -43,84 +56,173 @@ class autscc : public tools::input_output_tool
       timer().start("load");
       graph::Parser<graph_t::vertex_t, graph::aut> parser(
           graph);
-      parser.load(s);
+      parser.load(s, m_threads);
       timer().finish("load");
+      cpplog(cpplogging::verbose)
+        << "Spent " << parser.wait_time() << "s waiting for input." << std::endl;
       cpplog(cpplogging::verbose)
         << "Parity game contains " << graph.size() << " nodes and "
             << graph.num_edges() << " edges." << std::endl;
-    }
-
-    void
-    save(std::vector<std::list<graph::VertexIndex> >& sccs, std::ostream& s)
-    {
-      timer().start("save");
-      for (size_t i = 0; i < sccs.size(); ++i)
-      {
-        if (!sccs[i].empty())
-        {
-          for (std::list<graph::VertexIndex>::iterator n = sccs[i].begin(); n != sccs[i].end(); ++n)
-            s << *n << ' ';
-          s << std::endl;
-        }
-      }
-      timer().finish("save");
+      return parser.initial();
     }
 
     std::istream&
     open_input()
     {
-      std::istream* instream = &std::cin;
-      if (not m_input_filename.empty())
-      {
-        m_ifstream.reset(new std::ifstream());
-        m_ifstream->open(m_input_filename.c_str(), std::ios::in);
-        instream = m_ifstream.get();
-      }
-      else
+      std::istream& instream = m_input.open(m_input_filename);
+      if (m_input_filename.empty())
         m_input_filename = "standard input";
       cpplog(cpplogging::verbose)
-        << "Reading from " << m_input_filename << "." << std::endl;
-      return *instream;
+        << "Reading from " << m_input_filename
+        << (m_input.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return instream;
     }
 
     std::ostream&
     open_output()
     {
-      std::ostream* outstream = &std::cout;
-      if (not m_output_filename.empty())
-      {
-        m_ofstream.reset(new std::ofstream());
-        m_ofstream->open(m_output_filename.c_str(), std::ios::out);
-        outstream = m_ofstream.get();
-      }
-      else
+      std::ostream& outstream = m_output.open(m_output_filename);
+      if (m_output_filename.empty())
         m_output_filename = "standard output";
       cpplog(cpplogging::verbose)
-        << "Writing to " << m_output_filename << "." << std::endl;
-      return *outstream;
+        << "Writing to " << m_output_filename
+        << (m_output.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return outstream;
     }
 
+    /**
+     * @brief Writes the SCCs of the transition system in @a instream to
+     *   @a outstream, one line per SCC.
+     *
+     * SCCs are written as soon as Tarjan's algorithm completes them, which is
+     * in reverse topological order.
+     */
     void
     run_scc(std::istream& instream, std::ostream& outstream)
     {
-      graph_t* lts = new graph_t;
-      load(*lts, instream);
+      graph_t lts;
+      graph::VertexIndex initial = load(lts, instream);
+      std::vector<graph::VertexIndex> scc(lts.size(), 0);
+      std::vector<graph::VertexIndex> targets;
+      std::vector<size_t> histogram;
+      size_t count = 0, trivial = 0, largest = 0;
+      graph::lts::TransitionSystem dag;
+      graph::lts::Transition edge;
+      edge.label = dag.label_index("tau");
+
       timer().start("scc decomposition");
-      std::vector<graph::VertexIndex> scc;
-      scc.resize(lts->size());
-      size_t highscc = graph::impl::tarjan_iterative(lts->vertices(), scc);
-      delete lts;
+      graph::impl::AsyncWriter writer(outstream);
+      {
+        graph::impl::OutputBuffer out(&writer);
+        graph::impl::tarjan_iterative(lts.vertices(), scc,
+            [&](graph::VertexIndex id, std::vector<graph::VertexIndex>& members)
+        {
+          ++count;
+          std::sort(members.begin(), members.end());
+          bool is_trivial = members.size() == 1 and
+              not lts.vertex(members.front()).out.count(members.front());
+          if (is_trivial)
+            ++trivial;
+          if (m_statistics)
+          {
+            size_t bucket = 0;
+            while ((size_t)2 << bucket <= members.size())
+              ++bucket;
+            if (histogram.size() <= bucket)
+              histogram.resize(bucket + 1, 0);
+            ++histogram[bucket];
+            largest = members.size() > largest ? members.size() : largest;
+          }
+          if (not is_trivial or not m_nontrivial)
+          {
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+              out.put_uint(members[i]);
+              out.put(' ');
+            }
+            out.put('\n');
+          }
+          if (not m_dag_filename.empty())
+          {
+            targets.clear();
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+              const graph::VertexSet& succ = lts.vertex(members[i]).out;
+              for (graph::VertexSet::const_iterator w = succ.begin(); w != succ.end(); ++w)
+                if (scc[*w] != id)
+                  targets.push_back(scc[*w]);
+            }
+            std::sort(targets.begin(), targets.end());
+            targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+            edge.from = id;
+            for (size_t i = targets.size(); i-- > 0; )
+            {
+              edge.to = targets[i];
+              dag.transitions.push_back(edge);
+            }
+          }
+        });
+      }
+      writer.finish();
+      timer().finish("scc decomposition");
+      cpplog(cpplogging::verbose)
+        << "Found " << count << " SCCs, of which " << trivial << " trivial. Spent "
+            << writer.wait_time() << "s waiting for output." << std::endl;
 
-      std::vector<std::list<graph::VertexIndex> > sccs;
-      sccs.resize(highscc + 1);
-      for (graph::VertexIndex i = 0; i < scc.size(); ++i)
+      if (m_statistics)
+        report(count, trivial, largest, histogram);
+      if (not m_dag_filename.empty())
+        save_dag(dag, count, count ? scc[initial] : 0);
+    }
+
+    /// @brief Logs the number of SCCs of each size, in powers of two.
+    void
+    report(size_t count, size_t trivial, size_t largest, const std::vector<size_t>& histogram)
+    {
+      cpplog(cpplogging::info)
+        << count << " SCCs, " << trivial << " trivial and " << count - trivial
+            << " non-trivial; the largest SCC has " << largest << " states." << std::endl;
+      for (size_t i = 0; i < histogram.size(); ++i)
       {
-          sccs[scc[i]].push_back(i);
+        if (histogram[i] and i == 0)
+          cpplog(cpplogging::info)
+            << "  1 state: " << histogram[i] << " SCCs" << std::endl;
+        else if (histogram[i])
+          cpplog(cpplogging::info)
+            << "  " << ((size_t)1 << i) << " to " << ((size_t)2 << i) - 1 << " states: "
+                << histogram[i] << " SCCs" << std::endl;
       }
-      scc.clear();
+    }
 
-      timer().finish("scc decomposition");
-      save(sccs, outstream);
+    /**
+     * @brief Writes the condensation of the transition system to the file
+     *   given by --dag.
+     *
+     * The SCCs were numbered 1 to @a count in reverse topological order, and
+     * their outgoing transitions were collected in that order. Both are
+     * reversed, so that the states of the condensation are numbered, and its
+     * transitions are written, in topological order. @a initial is the SCC of
+     * the initial state, which becomes the initial state of the condensation.
+     */
+    void
+    save_dag(graph::lts::TransitionSystem& dag, size_t count, graph::VertexIndex initial)
+    {
+      timer().start("save");
+      std::reverse(dag.transitions.begin(), dag.transitions.end());
+      for (size_t i = 0; i < dag.transitions.size(); ++i)
+      {
+        dag.transitions[i].from = count - dag.transitions[i].from;
+        dag.transitions[i].to = count - dag.transitions[i].to;
+      }
+      dag.states = count;
+      dag.initial = count ? count - initial : 0;
+      std::ostream& s = m_dag.open(m_dag_filename);
+      cpplog(cpplogging::verbose)
+        << "Writing condensation to " << m_dag_filename
+        << (m_dag.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      graph::Parser<graph::lts::TransitionSystem, graph::aut> parser(dag);
+      parser.dump(s);
+      timer().finish("save");
     }
 
     /// @brief Runs the tool (see mcrl2::utilities::tools::input_output_tool::run).
@@ -132,6 +234,40 @@ class autscc : public tools::input_output_tool
       run_scc(instream, outstream);
       return true;
     }
+  protected:
+    /// @brief Adds the --threads, --nontrivial, --statistics and --dag options (see tools::input_output_tool::add_options).
+    void
+    add_options(interface_description& desc)
+    {
+      tools::input_output_tool::add_options(desc);
+      desc.add_option("threads", make_mandatory_argument("NUM"),
+          "Use up to NUM threads (default 1) to parse the input.");
+      desc.add_option("nontrivial",
+          "Only write SCCs that contain a cycle, i.e., that have more than one "
+          "state or a state with a self-loop.", 'n');
+      desc.add_option("statistics",
+          "Report the number of SCCs of each size.", 's');
+      desc.add_option("dag", make_mandatory_argument("FILE"),
+          "Write the condensation of the transition system to FILE in .aut format. "
+          "Its states are numbered, and its transitions written, in topological "
+          "order, which is the reverse of the order in which SCCs are written.");
+    }
+    /// @brief Parses the --threads, --nontrivial, --statistics and --dag options (see tools::input_output_tool::parse_options).
+    void
+    parse_options(const command_line_parser& parser)
+    {
+      tools::input_output_tool::parse_options(parser);
+      if (parser.options.count("threads"))
+      {
+        m_threads = parser.option_argument_as<size_t>("threads");
+        if (m_threads == 0)
+          parser.error("option --threads requires a positive number.");
+      }
+      m_nontrivial = parser.options.count("nontrivial") > 0;
+      m_statistics = parser.options.count("statistics") > 0;
+      if (parser.options.count("dag"))
+        m_dag_filename = parser.option_argument("dag");
+    }
 };
 
 int
@@ -0,0 +1,206 @@
+#ifndef __BATCH_H
+#define __BATCH_H
+
+#include "reducer.h"
+#include "streams.h"
+#include "detail/parallel.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @class Stopwatch
+ * @brief Records phase timings of a single job.
+ *
+ * Provides the @c start / @c finish interface that Reducer expects from its timer,
+ * but keeps the measurements in memory so they can be reported per job.
+ */
+class Stopwatch
+{
+  public:
+    typedef std::vector<std::pair<std::string, double> > timings_t;
+    void start(const std::string& name)
+    {
+      m_running[name] = std::chrono::steady_clock::now();
+    }
+    void finish(const std::string& name)
+    {
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - m_running[name];
+      m_running.erase(name);
+      m_timings.push_back(std::make_pair(name, elapsed.count()));
+    }
+    /// @brief Records a duration that was measured elsewhere.
+    void add(const std::string& name, double seconds)
+    {
+      m_timings.push_back(std::make_pair(name, seconds));
+    }
+    /// @brief Returns the finished timings, in the order they finished.
+    const timings_t& timings() const
+    {
+      return m_timings;
+    }
+  private:
+    std::map<std::string, std::chrono::steady_clock::time_point> m_running;
+    timings_t m_timings;
+};
+
+/// @brief Lets Reducer record I/O wait times in a Stopwatch (see ::record_duration).
+inline void
+record_duration(Stopwatch& stopwatch, const std::string& name, double seconds)
+{
+  stopwatch.add(name, seconds);
+}
+
+/**
+ * @class Batch
+ * @brief Reduces a list of parity games concurrently.
+ *
+ * Each game is loaded, reduced and saved by its own Reducer, so the only state
+ * shared between the worker threads is the list of jobs.
+ */
+class Batch
+{
+  public:
+    /// @brief Outcome of reducing a single game.
+    struct result_t
+    {
+      result_t() : nodes(0), edges(0), reduced_nodes(0), reduced_edges(0) {}
+      std::string input;
+      std::string output;
+      std::string error; ///< Empty if the game was reduced successfully.
+      size_t nodes;
+      size_t edges;
+      size_t reduced_nodes;
+      size_t reduced_edges;
+      Stopwatch::timings_t timings;
+    };
+
+    Batch(const ReductionOptions& options) :
+      m_options(options)
+    {
+      // The threads are spent on running games concurrently, which share the
+      // node pool; run() returns it to the global allocator instead.
+      m_options.threads = 1;
+      m_options.release = false;
+    }
+
+    /**
+     * @brief Returns the games listed by @a source.
+     * @param source Either a directory, in which case every regular file in it is
+     *   returned in lexicographic order, or a manifest file listing one game per
+     *   line. Empty lines and lines starting with '#' in a manifest are ignored.
+     */
+    static std::vector<std::string> inputs(const std::string& source)
+    {
+      namespace fs = boost::filesystem;
+      std::vector<std::string> result;
+      if (fs::is_directory(source))
+      {
+        for (fs::directory_iterator it(source); it != fs::directory_iterator(); ++it)
+          if (fs::is_regular_file(it->status()))
+            result.push_back(it->path().string());
+        std::sort(result.begin(), result.end());
+      }
+      else
+      {
+        std::ifstream manifest(source.c_str());
+        if (!manifest)
+          throw std::runtime_error("Could not open manifest " + source + ".");
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+          if (!line.empty() and line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+          if (!line.empty() and line[0] != '#')
+            result.push_back(line);
+        }
+      }
+      return result;
+    }
+
+    /**
+     * @brief Reduces every game in @a inputs, writing the results to @a outdir.
+     *
+     * The reduced game is written to a file with the same name as the input in
+     * @a outdir. A game that cannot be read or written does not stop the batch;
+     * its error is recorded in the corresponding result instead. The node
+     * pool is returned to the global allocator after every game if @a threads
+     * is 1, and after the last game otherwise (see graph::memory::release).
+     * @param threads The number of games that are reduced concurrently.
+     */
+    std::vector<result_t> run(const std::vector<std::string>& inputs,
+        const std::string& outdir, size_t threads)
+    {
+      namespace fs = boost::filesystem;
+      std::vector<result_t> results(inputs.size());
+      fs::create_directories(outdir);
+      graph::impl::parallel_for_each(inputs.size(), threads, [&](size_t i)
+      {
+        result_t& result = results[i];
+        result.input = inputs[i];
+        result.output = (fs::path(outdir) / fs::path(inputs[i]).filename()).string();
+        try
+        {
+          reduce(result);
+        }
+        catch (std::exception& e)
+        {
+          result.error = e.what();
+        }
+        if (threads == 1)
+          graph::memory::release();
+      });
+      graph::memory::release();
+      return results;
+    }
+
+    /**
+     * @brief Writes one tab-separated line per result to @a s.
+     *
+     * Each line contains the input file, the status, the number of nodes and edges
+     * before and after reduction and a name=seconds pair for every timed phase.
+     */
+    static void summary(const std::vector<result_t>& results, std::ostream& s)
+    {
+      for (size_t i = 0; i < results.size(); ++i)
+      {
+        const result_t& r = results[i];
+        s << r.input << '\t' << (r.error.empty() ? "ok" : "error: " + r.error)
+          << '\t' << r.nodes << '\t' << r.edges
+          << '\t' << r.reduced_nodes << '\t' << r.reduced_edges;
+        for (size_t t = 0; t < r.timings.size(); ++t)
+          s << '\t' << r.timings[t].first << '=' << r.timings[t].second;
+        s << '\n';
+      }
+      s << std::flush;
+    }
+  private:
+    ReductionOptions m_options;
+
+    void reduce(result_t& result)
+    {
+      Stopwatch stopwatch;
+      Reducer<Stopwatch> reducer(stopwatch, m_options);
+      Reducer<Stopwatch>::game_t game;
+      InputFile input;
+      reducer.load(game, input.open(result.input));
+      result.nodes = game.size();
+      result.edges = game.num_edges();
+      reducer.run(game);
+      result.reduced_nodes = game.size();
+      result.reduced_edges = game.num_edges();
+      OutputFile output;
+      reducer.save(game, output.open(result.output));
+      result.timings = stopwatch.timings();
+    }
+};
+
+#endif // __BATCH_H
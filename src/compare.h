@@ -0,0 +1,119 @@
+#ifndef __COMPARE_H
+#define __COMPARE_H
+
+#include "batch.h"
+#include "detail/parallel.h"
+
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class Comparison
+ * @brief Computes the quotients of one parity game modulo several equivalences.
+ *
+ * The game is loaded once and shared by all reductions, which only read it (see
+ * Reducer::quotient). Every reduction has its own Reducer and Stopwatch, and its
+ * partitioner keeps its own per-vertex state, so the reductions can run
+ * concurrently.
+ */
+class Comparison
+{
+  public:
+    typedef Reducer<Stopwatch>::game_t game_t;
+
+    /// @brief Outcome of reducing the game modulo a single equivalence.
+    struct result_t
+    {
+      result_t() : nodes(0), edges(0), seconds(0) {}
+      Equivalence equivalence;
+      std::string error; ///< Empty if the reduction succeeded.
+      size_t nodes;
+      size_t edges;
+      double seconds; ///< The time spent computing the quotient.
+      Stopwatch::timings_t timings;
+    };
+
+    Comparison(const ReductionOptions& options) :
+      m_options(options)
+    {
+      // The threads are spent on running reductions concurrently.
+      m_options.threads = 1;
+      m_options.release = false;
+    }
+
+    /**
+     * @brief Reduces @a game modulo every equivalence in the pipeline.
+     * @param threads The number of reductions that run concurrently.
+     */
+    std::vector<result_t> run(const game_t& game, size_t threads)
+    {
+      std::vector<result_t> results(m_options.pipeline.size());
+      graph::impl::parallel_for_each(results.size(), threads, [&](size_t i)
+      {
+        result_t& result = results[i];
+        result.equivalence = m_options.pipeline[i];
+        try
+        {
+          reduce(game, result);
+        }
+        catch (std::exception& e)
+        {
+          result.error = e.what();
+        }
+      });
+      return results;
+    }
+
+    /**
+     * @brief Writes a table with the size of every quotient to @a s.
+     *
+     * The first row gives the size of the game itself; every other row gives the
+     * size of a quotient, its size relative to the game, and the time it took.
+     */
+    static void summary(const game_t& game, const std::vector<result_t>& results,
+        std::ostream& s)
+    {
+      size_t nodes = game.size(), edges = game.num_edges();
+      s << std::left << std::setw(12) << "equivalence" << std::right
+        << std::setw(12) << "nodes" << std::setw(12) << "edges"
+        << std::setw(10) << "nodes %" << std::setw(12) << "time (s)" << '\n';
+      s << std::left << std::setw(12) << "input" << std::right
+        << std::setw(12) << nodes << std::setw(12) << edges << '\n';
+      for (size_t i = 0; i < results.size(); ++i)
+      {
+        const result_t& r = results[i];
+        s << std::left << std::setw(12) << r.equivalence.name() << std::right;
+        if (!r.error.empty())
+        {
+          s << "  error: " << r.error << '\n';
+          continue;
+        }
+        s << std::setw(12) << r.nodes << std::setw(12) << r.edges
+          << std::setw(10) << std::fixed << std::setprecision(2)
+          << (nodes ? 100.0 * r.nodes / nodes : 100.0)
+          << std::setw(12) << std::setprecision(3) << r.seconds << '\n';
+        s.unsetf(std::ios::floatfield);
+      }
+      s << std::flush;
+    }
+  private:
+    ReductionOptions m_options;
+
+    void reduce(const game_t& game, result_t& result)
+    {
+      Stopwatch stopwatch;
+      Reducer<Stopwatch> reducer(stopwatch, m_options);
+      game_t quotient;
+      stopwatch.start("reduction");
+      reducer.quotient(result.equivalence, game, quotient);
+      stopwatch.finish("reduction");
+      result.nodes = quotient.size();
+      result.edges = quotient.num_edges();
+      result.timings = stopwatch.timings();
+      result.seconds = result.timings.back().second;
+    }
+};
+
+#endif // __COMPARE_H
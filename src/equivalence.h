@@ -1,3 +1,6 @@
+#ifndef __EQUIVALENCE_H
+#define __EQUIVALENCE_H
+
 #include <string>
 
 /**
@@ -22,6 +25,8 @@ public:
   };
   /// @brief Default constructor.
   Equivalence() {}
+  /// @brief Constructs an Equivalence object representing @a value.
+  Equivalence(Eq value) : m_value(value) {}
   /// @brief Copy constructor.
   Equivalence(const Equivalence& other) : m_value(other.m_value) {}
   /**
@@ -73,3 +78,5 @@ private:
   static const char* m_names[invalid + 1];
   static const char* m_descs[invalid + 1];
 };
+
+#endif // __EQUIVALENCE_H
@@ -0,0 +1,246 @@
+#include "parsers/aut.h"
+#include "bisim.h"
+#include "stut.h"
+#include "lts.h"
+#include "streams.h"
+
+#include "cppcli/input_output_tool.h"
+#include "cpplogging/logger.h"
+
+#include <sstream>
+#include <iostream>
+#include <fstream>
+
+/**
+ * @class ltsconvert
+ * @brief Tool class that minimises labelled transition systems.
+ */
+class ltsconvert : public tools::input_output_tool
+{
+  private:
+    enum equivalence_t
+    {
+      none, ///< Only convert the input.
+      bisim, ///< Strong bisimulation.
+      dpbranching ///< Divergence-preserving branching bisimulation.
+    };
+    equivalence_t m_equivalence;
+    std::string m_tau; ///< The name of the internal action.
+    size_t m_threads; ///< The number of threads given by --threads.
+    InputFile m_input;
+    OutputFile m_output;
+  public:
+    typedef graph::lts::TransitionSystem lts_t;
+    ltsconvert() :
+        tools::input_output_tool(
+        // Tool name:
+            "ltsconvert",
+            // Author:
+            "S. Cranen",
+            // Tool summary:
+            "Minimises labelled transition systems in .aut format.",
+            // Tool description:
+            "Reads a labelled transition system in Aldebaran (.aut) format, reduces "
+            "it modulo strong bisimulation or divergence-preserving branching "
+            "bisimulation, and writes the result in Aldebaran format. The "
+            "transition system is encoded as a Kripke structure in which every "
+            "transition passes through a vertex labelled with its action, and is "
+            "then reduced by the same partitioners that pgconvert uses.",
+            // Known issues:
+            "None"),
+        m_equivalence(none), m_tau("tau"), m_threads(1)
+    {
+    }
+
+    void
+    load(lts_t& lts, std::istream& s)
+    {
+      cpplog(cpplogging::verbose)
+        << "Loading transition system." << std::endl;
+      timer().start("load");
+      graph::Parser<lts_t, graph::aut> parser(lts);
+      parser.load(s, m_threads);
+      timer().finish("load");
+      cpplog(cpplogging::verbose)
+        << "Spent " << parser.wait_time() << "s waiting for input." << std::endl;
+      report(lts, "");
+    }
+
+    void
+    save(lts_t& lts, std::ostream& s)
+    {
+      timer().start("save");
+      graph::Parser<lts_t, graph::aut> parser(lts);
+      parser.dump(s);
+      timer().finish("save");
+    }
+
+    void
+    report(const lts_t& lts, const char* when)
+    {
+      cpplog(cpplogging::verbose)
+        << "Transition system contains " << lts.states << " states, "
+            << lts.transitions.size() << " transitions and " << lts.labels.size()
+            << " action labels" << when << "." << std::endl;
+    }
+
+    /// @brief Stores the quotient of @a lts modulo strong bisimulation in @a result.
+    void
+    reduce_bisim(const lts_t& lts, lts_t& result)
+    {
+      typedef graph::BisimulationPartitioner<graph::lts::ActionLabel> partitioner_t;
+      partitioner_t::graph_t graph;
+      partitioner_t::graph_t quotient;
+      timer().start("encode");
+      lts.encode(graph);
+      timer().finish("encode");
+      partitioner_t partitioner(graph);
+      timer().start("partition refinement");
+      partitioner.partition(&quotient);
+      timer().finish("partition refinement");
+      timer().start("decode");
+      lts.decode(quotient, partitioner.block_index(lts.initial), lts_t::no_label, result);
+      timer().finish("decode");
+    }
+
+    /**
+     * @brief Stores the quotient of @a lts modulo divergence-preserving branching
+     *   bisimulation in @a result.
+     *
+     * Internal transitions are encoded as direct edges, so that stuttering
+     * equivalence of the encoding is branching bisimulation. Cycles of internal
+     * transitions are collapsed first, and the resulting divergent vertices get
+     * an edge to a separate vertex, which the reduction has to preserve.
+     */
+    void
+    reduce_dpbranching(const lts_t& lts, lts_t& result)
+    {
+      typedef graph::StutteringPartitioner<graph::lts::ActionLabel> partitioner_t;
+      partitioner_t::graph_t graph;
+      partitioner_t::graph_t quotient;
+      graph::lts::LabelIndex tau = lts.find_label(m_tau);
+      timer().start("encode");
+      lts.encode(graph, tau);
+      timer().finish("encode");
+
+      std::vector<graph::VertexIndex> index;
+      timer().start("scc reduction");
+      graph.collapse_sccs(&index);
+      timer().finish("scc reduction");
+      graph.resize(graph.size() + 1);
+      partitioner_t::vertex_t& divmark = graph.vertex(graph.size() - 1);
+      divmark.label.div = 1;
+      for (size_t i = 0; i < graph.size() - 1; ++i)
+      {
+        partitioner_t::vertex_t& v = graph.vertex(i);
+        if (v.label.div)
+        {
+          v.out.insert(graph.size() - 1);
+          divmark.in.insert(i);
+          v.label.div = 0;
+        }
+      }
+      cpplog(cpplogging::verbose)
+        << "Encoding contains " << graph.size() << " vertices and " << graph.num_edges()
+            << " edges after SCC reduction." << std::endl;
+
+      partitioner_t partitioner(graph);
+      timer().start("partition refinement");
+      partitioner.partition(&quotient);
+      timer().finish("partition refinement");
+      timer().start("decode");
+      lts.decode(quotient, partitioner.block_index(index[lts.initial]), tau, result);
+      timer().finish("decode");
+    }
+
+    /// @brief Runs the tool (see tools::input_output_tool::run).
+    bool
+    run()
+    {
+      lts_t lts;
+      load(lts, open_input());
+      if (m_equivalence != none and lts.states > 0)
+      {
+        lts_t result;
+        if (m_equivalence == bisim)
+          reduce_bisim(lts, result);
+        else
+          reduce_dpbranching(lts, result);
+        std::swap(lts, result);
+        report(lts, " after reduction");
+      }
+      save(lts, open_output());
+      return true;
+    }
+
+    std::istream&
+    open_input()
+    {
+      std::istream& instream = m_input.open(m_input_filename);
+      if (m_input_filename.empty())
+        m_input_filename = "standard input";
+      cpplog(cpplogging::verbose)
+        << "Reading from " << m_input_filename
+        << (m_input.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return instream;
+    }
+
+    std::ostream&
+    open_output()
+    {
+      std::ostream& outstream = m_output.open(m_output_filename);
+      if (m_output_filename.empty())
+        m_output_filename = "standard output";
+      cpplog(cpplogging::verbose)
+        << "Writing to " << m_output_filename
+        << (m_output.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return outstream;
+    }
+  protected:
+    /// @brief Adds the --equivalence, --tau and --threads options (see tools::input_output_tool::add_options).
+    void
+    add_options(interface_description& desc)
+    {
+      tools::input_output_tool::add_options(desc);
+      desc.add_option("equivalence", make_mandatory_argument("NAME"),
+          "Reduce the transition system modulo NAME, which is 'none' (default; "
+          "only convert the input), 'bisim' (strong bisimulation) or "
+          "'dpbranching-bisim' (divergence-preserving branching bisimulation).", 'e');
+      desc.add_option("tau", make_mandatory_argument("NAME"),
+          "Treat actions named NAME as internal (default 'tau').");
+      desc.add_option("threads", make_mandatory_argument("NUM"),
+          "Use up to NUM threads (default 1) to parse the input.");
+    }
+    /// @brief Parses the --equivalence, --tau and --threads options (see tools::input_output_tool::parse_options).
+    void
+    parse_options(const command_line_parser& parser)
+    {
+      tools::input_output_tool::parse_options(parser);
+      if (parser.options.count("equivalence"))
+      {
+        std::string name = parser.option_argument("equivalence");
+        if (name == "none")
+          m_equivalence = none;
+        else if (name == "bisim")
+          m_equivalence = bisim;
+        else if (name == "dpbranching-bisim")
+          m_equivalence = dpbranching;
+        else
+          parser.error("option -e/--equivalence has illegal argument '" + name + "'");
+      }
+      if (parser.options.count("tau"))
+        m_tau = parser.option_argument("tau");
+      if (parser.options.count("threads"))
+      {
+        m_threads = parser.option_argument_as<size_t>("threads");
+        if (m_threads == 0)
+          parser.error("option --threads requires a positive number.");
+      }
+    }
+};
+
+int
+main(int argc, char** argv)
+{
+  return std::auto_ptr<ltsconvert>(new ltsconvert())->execute(argc, argv);
+}
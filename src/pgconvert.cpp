@@ -1,12 +1,11 @@
 #include "equivalence.h"
-#include "parsers/pgsolver.h"
-#include "parsers/dot.h"
-#include "govstut.h"
-#include "wgovstut.h"
-#include "bisim.h"
-#include "fmib.h"
-#include "stut.h"
-#include "pg.h"
+#include "reducer.h"
+#include "batch.h"
+#include "compare.h"
+#include "streams.h"
+#include "mapping.h"
+#include "trace.h"
+#include "memusage.h"
 
 #include "cppcli/input_output_tool.h"
 #include "cpplogging/logger.h"
@@ -22,9 +21,19 @@
 class pgconvert : public tools::input_output_tool
 {
   private:
-    Equivalence m_equivalence;
-    std::auto_ptr<std::ifstream> m_ifstream;
-    std::auto_ptr<std::ofstream> m_ofstream;
+    ReductionOptions m_options;
+    bool m_batch; ///< Reduce every game listed by the input instead of a single game.
+    bool m_compare; ///< Compare the reductions instead of applying them in sequence.
+    bool m_query; ///< Decide whether two vertices are equivalent instead of reducing.
+    graph::VertexIndex m_query_vertices[2]; ///< The vertices given by --query.
+    std::string m_query_filename; ///< The game given by --query-with, if any.
+    size_t m_threads; ///< The number of threads given by --threads.
+    std::string m_mapping_filename; ///< File to which the vertex mapping is written.
+    bool m_binary_mapping; ///< Write the vertex mapping in binary format.
+    std::string m_stats_filename; ///< File to which the partitioner statistics are written.
+    std::string m_trace_filename; ///< File to which the trace is written, if any.
+    InputFile m_input;
+    OutputFile m_output;
   public:
     pgconvert() :
   tools::input_output_tool(
@@ -38,309 +47,176 @@ class pgconvert : public tools::input_output_tool
       "Tool that can reduce parity games modulo stuttering equivalence and "
     "governed stuttering equivalence.",
       // Known issues:
-      "None")
+      "None"),
+      m_batch(false), m_compare(false), m_query(false), m_threads(1), m_binary_mapping(false)
     {
+      m_query_vertices[0] = m_query_vertices[1] = 0;
     }
 
-    template<typename graph_t, typename partitioner_t>
-    void dump_dot(graph_t& graph, partitioner_t& partitioner)
-    {
-      typedef typename graph_t::vertex_t vertex_t;
-      graph::pg::VertexFormatter<vertex_t> fmt;
-      graph::Parser<vertex_t, graph::dot> p(graph, fmt);
-      p.dump(std::cout, partitioner);
-    }
-
-    template<typename graph_t>
-    void
-    collapse_sccs(graph_t& graph)
+    std::istream&
+    open_input()
     {
-      timer().start("scc reduction");
-      graph.collapse_sccs();
-      timer().finish("scc reduction");
+      std::istream& instream = m_input.open(m_input_filename);
+      if (m_input_filename.empty())
+  m_input_filename = "standard input";
       cpplog(cpplogging::verbose)
-  << "Parity game contains " << graph.size() << " nodes and "
-      << graph.num_edges() << " edges after SCC reduction."
-      << std::endl;
+  << "Reading from " << m_input_filename
+  << (m_input.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return instream;
     }
 
-    template<typename graph_t>
-    void
-    encode_divergence(graph_t& pg)
+    std::ostream&
+    open_output()
     {
-      pg.resize(pg.size() + 1);
-      typename graph_t::vertex_t& divmark = pg.vertex(pg.size() - 1);
-      divmark.label.div = true;
-      for (size_t i = 0; i < pg.size() - 1; ++i)
-      {
-  typename graph_t::vertex_t& v = pg.vertex(i);
-  if (v.label.div)
-  {
-    v.out.insert(pg.size() - 1);
-    divmark.in.insert(i);
-    v.label.div = false;
-  }
-      }
+      std::ostream& outstream = m_output.open(m_output_filename);
+      if (m_output_filename.empty())
+  m_output_filename = "standard output";
+      cpplog(cpplogging::verbose)
+  << "Writing to " << m_output_filename
+  << (m_output.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return outstream;
     }
 
-    template<typename graph_t>
+    template<typename Timer>
     void
-    decode_divergence(graph_t& pg)
+    run_single(Timer& timer)
     {
-      size_t div = 0;
-      for (size_t i = 0; i < pg.size(); ++i)
+      Reducer<Timer> reducer(timer, m_options);
+      typename Reducer<Timer>::game_t game;
+      std::istream& instream = open_input();
+      std::ostream& outstream = open_output();
+      reducer.load(game, instream);
+      reducer.run(game, &outstream);
+      if (m_options.mapping)
       {
-  if (pg.vertex(i).label.div)
-  {
-    div = i;
-    typename graph_t::vertex_t& v = pg.vertex(div);
-    for (graph::VertexSet::iterator j = v.in.begin(); j != v.in.end();
-        ++j)
-        {
-      pg.vertex(*j).out.erase(i);
-      pg.vertex(*j).out.insert(*j);
-      pg.vertex(*j).in.insert(*j);
-    }
-    pg.vertex(i).in.clear();
-  }
+        timer.start("save mapping");
+        std::ofstream mapstream(m_mapping_filename.c_str(),
+            std::ios::out | std::ios::binary);
+        if (!mapstream)
+          throw std::runtime_error("Could not open " + m_mapping_filename + ".");
+        graph::mapping::write(mapstream, reducer.mapping(), m_binary_mapping);
+        timer.finish("save mapping");
       }
-      for (size_t i = 0; i < pg.size(); ++i)
+      if (m_options.statistics)
       {
-  graph::VertexSet in, out;
-  for (graph::VertexSet::iterator it = pg.vertex(i).in.begin();
-      it != pg.vertex(i).in.end(); ++it)
-    in.insert(*it - (*it > div ? 1 : 0));
-  for (graph::VertexSet::iterator it = pg.vertex(i).out.begin();
-      it != pg.vertex(i).out.end(); ++it)
-    out.insert(*it - (*it > div ? 1 : 0));
-  pg.vertex(i).in.swap(in);
-  pg.vertex(i).out.swap(out);
-  if (i > div)
-    pg.vertex(i - 1) = pg.vertex(i);
+        std::ofstream statstream(m_stats_filename.c_str());
+        if (!statstream)
+          throw std::runtime_error("Could not open " + m_stats_filename + ".");
+        write_statistics(statstream, m_input_filename, reducer.statistics());
       }
-      pg.resize(pg.size() - 1);
-      cpplog(cpplogging::verbose)
-  << "Parity game contains " << pg.size() << " nodes and "
-      << pg.num_edges() << " edges after restoring divergences."
-      << std::endl;
     }
 
-    template<typename partitioner_t, typename graph_t>
+    template<typename Timer>
     void
-    partition(Equivalence e, partitioner_t& partitioner, graph_t* output =
-  NULL)
+    run_batch(Timer& timer)
     {
-      timer().start("partition refinement");
-      partitioner.partition(output);
-      timer().finish("partition refinement");
-      if (output)
-      {
-  cpplog(cpplogging::verbose)
-    << "Parity game contains " << output->size() << " nodes and "
-        << output->num_edges() << " edges after " << e.desc()
-        << " reduction." << std::endl;
-      }
+      Batch batch(m_options);
+      std::vector<std::string> inputs = Batch::inputs(m_input_filename);
+      cpplog(cpplogging::verbose)
+        << "Reducing " << inputs.size() << " parity games using "
+        << m_threads << " threads." << std::endl;
+      timer.start("batch");
+      std::vector<Batch::result_t> results =
+          batch.run(inputs, m_output_filename, m_threads);
+      timer.finish("batch");
+      Batch::summary(results, std::cout);
     }
 
-    template<typename graph_t>
+    template<typename Timer>
     void
-    load(graph_t& graph, std::istream& s)
+    run_compare(Timer& timer)
     {
+      Reducer<Timer> reducer(timer, m_options);
+      typename Reducer<Timer>::game_t game;
+      reducer.load(game, open_input());
+      if (m_options.prune)
+        reducer.prune(game);
+      if (m_options.reorder != graph::original_order)
+        reducer.reorder(game);
+      Comparison comparison(m_options);
       cpplog(cpplogging::verbose)
-  << "Loading parity game." << std::endl;
-      timer().start("load");
-      graph::Parser<typename graph_t::vertex_t, graph::pgsolver> parser(graph);
-      parser.load(s);
-      timer().finish("load");
-      cpplog(cpplogging::verbose)
-  << "Parity game contains " << graph.size() << " nodes and "
-      << graph.num_edges() << " edges." << std::endl;
+        << "Comparing " << m_options.pipeline.size() << " reductions using "
+        << m_threads << " threads." << std::endl;
+      timer.start("compare");
+      std::vector<Comparison::result_t> results = comparison.run(game, m_threads);
+      timer.finish("compare");
+      Comparison::summary(game, results, open_output());
     }
 
-    template<typename graph_t>
+    /**
+     * @brief Decides whether the vertices given by --query, or vertex 0 of the
+     *   input and of the game given by --query-with, are equivalent, and
+     *   writes the answer to the output.
+     */
+    template<typename Timer>
     void
-    save(graph_t& graph, std::ostream& s)
-    {
-      timer().start("save");
-      graph::Parser<typename graph_t::vertex_t, graph::pgsolver> parser(
-    graph);
-      parser.dump(s);
-      s << std::flush;
-      timer().finish("save");
-    }
-
-    std::istream&
-    open_input()
+    run_query(Timer& timer)
     {
-      std::istream* instream = &std::cin;
-      if (not m_input_filename.empty())
+      typedef typename Reducer<Timer>::game_t game_t;
+      Reducer<Timer> reducer(timer, m_options);
+      game_t game;
+      reducer.load(game, open_input());
+      graph::VertexIndex v = m_query_vertices[0], w = m_query_vertices[1];
+      if (not m_query_filename.empty())
       {
-  m_ifstream.reset(new std::ifstream());
-  m_ifstream->open(m_input_filename.c_str(), std::ios::in);
-  instream = m_ifstream.get();
+        InputFile input;
+        game_t other;
+        cpplog(cpplogging::verbose)
+          << "Reading from " << m_query_filename << "." << std::endl;
+        reducer.load(other, input.open(m_query_filename), "load second game");
+        if (game.empty() or other.empty())
+          throw std::runtime_error("Both parity games must have a vertex 0.");
+        if (game.size() + other.size() > graph::max_vertices)
+          throw std::runtime_error("The parity games are too large for this build (see GRAPH_32BIT_INDICES).");
+        v = 0;
+        w = game.size();
+        game.append(other);
       }
-      else
-  m_input_filename = "standard input";
-      cpplog(cpplogging::verbose)
-  << "Reading from " << m_input_filename << "." << std::endl;
-      return *instream;
-    }
-
-    std::ostream&
-    open_output()
-    {
-      std::ostream* outstream = &std::cout;
-      if (not m_output_filename.empty())
+      else if (v >= game.size() or w >= game.size())
       {
-  m_ofstream.reset(new std::ofstream());
-  m_ofstream->open(m_output_filename.c_str(), std::ios::out);
-  outstream = m_ofstream.get();
+        std::stringstream msg;
+        msg << "The parity game has no vertex " << std::max(v, w) << ".";
+        throw std::runtime_error(msg.str());
       }
-      else
-  m_output_filename = "standard output";
-      cpplog(cpplogging::verbose)
-  << "Writing to " << m_output_filename << "." << std::endl;
-      return *outstream;
-    }
-
-    void
-    run_scc(std::istream& instream, std::ostream& outstream)
-    {
-      typedef graph::KripkeStructure<graph::Vertex<graph::pg::DivLabel> > graph_t;
-      graph_t pg;
-      load(pg, instream);
-      timer().start("reduction");
-      collapse_sccs(pg);
-      for (size_t i = 0; i < pg.size(); ++i)
+      Equivalence e = m_options.pipeline[0];
+      timer.start("query");
+      bool result = reducer.equivalent(e, game, v, w);
+      timer.finish("query");
+      if (m_options.statistics)
       {
-  if (pg.vertex(i).label.div)
-    pg.vertex(i).out.insert(i);
+        std::ofstream statstream(m_stats_filename.c_str());
+        if (!statstream)
+          throw std::runtime_error("Could not open " + m_stats_filename + ".");
+        write_statistics(statstream, m_input_filename, reducer.statistics());
       }
-      timer().finish("reduction");
-      save(pg, outstream);
-    }
-
-    void
-    run_bisim(std::istream& instream, std::ostream& outstream)
-    {
-      typedef graph::BisimulationPartitioner<graph::pg::DivLabel>::graph_t graph_t;
-      graph_t pg;
-      graph_t output;
-      graph::BisimulationPartitioner<graph::pg::DivLabel> p(pg);
-      load(pg, instream);
-      timer().start("reduction");
-      partition(m_equivalence, p, &output);
-      timer().finish("reduction");
-      save(output, outstream);
-    }
-
-    void
-    run_fmib(std::istream& instream, std::ostream& outstream)
-    {
-      typedef graph::pg::FMIBPartitioner<graph::pg::DivLabel>::graph_t graph_t;
-      graph_t pg;
-      graph_t output;
-      graph::pg::FMIBPartitioner<graph::pg::DivLabel> p(pg);
-      load(pg, instream);
-      timer().start("reduction");
-      partition(m_equivalence, p, &output);
-      timer().finish("reduction");
-      save(output, outstream);
-    }
-
-    void
-    run_stut(std::istream& instream, std::ostream& outstream)
-    {
-      typedef graph::StutteringPartitioner<graph::pg::DivLabel>::graph_t graph_t;
-      graph_t pg;
-      graph_t output;
-      graph::StutteringPartitioner<graph::pg::DivLabel> p(pg);
-      load(pg, instream);
-      timer().start("reduction");
-      collapse_sccs(pg);
-      encode_divergence(pg);
-      partition(m_equivalence, p, &output);
-      decode_divergence(output);
-      timer().finish("reduction");
-      save(output, outstream);
-    }
-
-    void
-    run_gstut(std::istream& instream, std::ostream& outstream)
-    {
-      typedef graph::pg::GovernedStutteringPartitioner<graph::pg::Label>::graph_t graph_t;
-      graph_t pg;
-      graph_t output;
-      graph::pg::GovernedStutteringPartitioner<graph::pg::Label> p(pg);
-      load(pg, instream);
-      timer().start("reduction");
-      partition(m_equivalence, p, &output);
-      timer().finish("reduction");
-      save(output, outstream);
-    }
-
-    void
-    run_scc_gstut(std::istream& instream, std::ostream& outstream)
-    {
-      typedef graph::pg::GovernedStutteringPartitioner<graph::pg::DivLabel>::graph_t graph_t;
-      graph_t pg;
-      graph_t output;
-      graph::pg::GovernedStutteringPartitioner<graph::pg::DivLabel> p(pg);
-      load(pg, instream);
-      timer().start("reduction");
-      collapse_sccs(pg);
-      encode_divergence(pg);
-      partition(m_equivalence, p, &output);
-      decode_divergence(output);
-      timer().finish("reduction");
-      save(output, outstream);
-    }
-
-    void
-    run_wgstut(std::istream& instream, std::ostream& outstream)
-    {
-      typedef graph::pg::GovernedStutteringPartitioner<graph::pg::Label>::graph_t graph_t;
-      graph_t pg1;
-      graph_t pg2;
-      graph::pg::ParadisePartitioner<graph::pg::Label> pp(pg1);
-      graph::pg::GovernedStutteringPartitioner<graph::pg::Label> gsp(pg2);
-      load(pg1, instream);
-      timer().start("reduction");
-      timer().start("paradise reduction");
-      pp.partition(&pg2);
-      timer().finish("paradise reduction");
-      pg1.resize(0);
-      partition(m_equivalence, gsp, &pg1);
-      timer().finish("reduction");
-      save(pg1, outstream);
+      open_output() << (result ? "equivalent" : "not equivalent") << std::endl;
     }
 
     /// @brief Runs the tool (see tools::input_output_tool::run).
     bool
     run()
     {
-      std::istream& instream = open_input();
-      std::ostream& outstream = open_output();
-      cpplog(cpplogging::verbose)
-  << "Performing " << m_equivalence.desc() << " reduction." << std::endl;
-      if (m_equivalence == Equivalence::scc)
-  run_scc(instream, outstream);
-      else if (m_equivalence == Equivalence::bisim)
-  run_bisim(instream, outstream);
-      else if (m_equivalence == Equivalence::fmib)
-  run_fmib(instream, outstream);
-      else if (m_equivalence == Equivalence::stut)
-  run_stut(instream, outstream);
-      else if (m_equivalence == Equivalence::gstut)
-  run_gstut(instream, outstream);
-      else if (m_equivalence == Equivalence::scc_gstut)
-  run_scc_gstut(instream, outstream);
-      else if (m_equivalence == Equivalence::wgstut)
-  run_wgstut(instream, outstream);
+      if (not m_trace_filename.empty())
+        graph::trace::enable();
+      if (m_batch)
+        run_batch(timer());
+      else if (m_compare)
+        run_compare(timer());
+      else if (m_query)
+        run_query(timer());
+      else
+        run_single(timer());
+      if (not m_trace_filename.empty())
+      {
+        std::ofstream tracestream(m_trace_filename.c_str());
+        if (!tracestream)
+          throw std::runtime_error("Could not open " + m_trace_filename + ".");
+        graph::trace::write(tracestream);
+      }
       return true;
     }
   protected:
-    /// @brief Adds the --equivalence option (see tools::input_output_tool::add_options).
+    /// @brief Adds the --equivalence, reduction options (see tools::input_output_tool::add_options).
     void
     add_options(interface_description& desc)
     {
@@ -355,27 +231,188 @@ class pgconvert : public tools::input_output_tool
   eq = Equivalence::name(++i);
       }
       desc.add_option("equivalence",
-    make_mandatory_argument("NAME"),
-    "The conversion method to use, choose from" + eqs.str(), 'e');
+    make_mandatory_argument("NAME[,NAME]..."),
+    "The conversion method to use, choose from" + eqs.str() + "\n"
+    "A comma-separated list of methods applies the reductions in sequence.", 'e');
+      desc.add_option("fixpoint",
+    "Repeat the sequence of reductions given by --equivalence until the "
+    "parity game no longer shrinks.");
+      desc.add_option("prune",
+    "Remove the vertices that are unreachable from vertex 0 before reducing.");
+      desc.add_option("reorder", make_mandatory_argument("ORDER"),
+    "Renumber the vertices before reducing, to improve the locality of memory "
+    "accesses. ORDER is 'bfs' (breadth-first from vertex 0), 'rcm' (reverse "
+    "Cuthill-McKee) or 'scc' (strongly connected components in topological "
+    "order). Vertex 0 keeps its index, and --mapping still refers to the "
+    "vertices of the input.");
+      desc.add_option("mapping", make_mandatory_argument("FILE"),
+    "Write to FILE, for every vertex of the input, the index of the vertex "
+    "that represents it in the output ('-' if it was removed). The result can "
+    "be used with pglift to lift a solution of the output to the input.");
+      desc.add_option("mapping-format", make_mandatory_argument("FORMAT"),
+    "Write the mapping in FORMAT, which is 'text' (default; one index per "
+    "line) or 'binary'.");
+      desc.add_option("format", make_mandatory_argument("FORMAT"),
+    "Write the parity game in FORMAT, which is 'pgsolver' (default) or "
+    "'binary', a compact format that pgconvert reads back. The input format is "
+    "recognised automatically.");
+      desc.add_option("stats", make_mandatory_argument("FILE"),
+    "Write to FILE, as JSON, the counters of every partition refinement: the "
+    "number of rounds, attempted and successful splits, moved vertices, "
+    "scanned edges and attractor visits, and a histogram of the block sizes.");
+      desc.add_option("trace", make_mandatory_argument("FILE"),
+    "Write a timeline of the phases of the reduction, per thread, to FILE in "
+    "the Chrome trace event format, which can be viewed in chrome://tracing or "
+    "ui.perfetto.dev.");
+      desc.add_option("max-memory", make_mandatory_argument("MB"),
+    "Stop with an error message once the resident memory of the process, or "
+    "the memory taken by adjacency sets and partition lists, exceeds MB "
+    "mebibytes. The limit is checked at every allocation for those containers "
+    "and at the start and end of every phase.");
+      desc.add_option("batch",
+    "Treat INFILE as a directory or a manifest file listing one parity game "
+    "per line, and write each reduced game to the directory OUTFILE. A summary "
+    "of sizes and timings is written to standard output.");
+      desc.add_option("compare",
+    "Load the parity game once and reduce it modulo every method given by "
+    "--equivalence separately, instead of in sequence. A table with the size "
+    "of every quotient and the time it took is written to OUTFILE.");
+      desc.add_option("query", make_mandatory_argument("V,W"),
+    "Decide whether vertices V and W of INFILE are equivalent modulo the "
+    "single method given by --equivalence (bisim, fmib, stut or gstut), and "
+    "write 'equivalent' or 'not equivalent' to OUTFILE. Refinement stops as "
+    "soon as V and W are found to differ, and no quotient is computed.");
+      desc.add_option("query-with", make_mandatory_argument("FILE"),
+    "Like --query, but decide whether vertex 0 of INFILE and vertex 0 of the "
+    "parity game in FILE are equivalent, in the disjoint union of both games.");
+      desc.add_option("threads", make_mandatory_argument("NUM"),
+    "Use up to NUM threads (default 1). In batch mode, NUM parity games are "
+    "reduced concurrently, and with --compare, NUM reductions run "
+    "concurrently; otherwise the threads are used within a reduction.");
     }
-    /// @brief Parses the --equivalence option (see tools::input_output_tool::parse_options).
+    /// @brief Parses the --equivalence, reduction options (see tools::input_output_tool::parse_options).
     void
     parse_options(const command_line_parser& parser)
     {
       tools::input_output_tool::parse_options(parser);
       if (parser.options.count("equivalence"))
       {
-  m_equivalence = Equivalence(parser.option_argument("equivalence"));
-  if (m_equivalence == Equivalence::invalid)
+  std::stringstream names(parser.option_argument("equivalence"));
+  std::string name;
+  while (std::getline(names, name, ','))
   {
-    parser.error(
-        "option -e/--equivalence has illegal argument '"
-      + parser.option_argument("equivalence") + "'");
+    Equivalence e(name);
+    if (e == Equivalence::invalid)
+    {
+      parser.error(
+          "option -e/--equivalence has illegal argument '"
+        + parser.option_argument("equivalence") + "'");
+    }
+    m_options.pipeline.push_back(e);
   }
+  if (m_options.pipeline.empty())
+    parser.error("option -e/--equivalence requires at least one method.");
       }
       else
   parser.error(
       "please specify an conversion method using the -e option.");
+      m_options.fixpoint = parser.options.count("fixpoint") > 0;
+      m_options.prune = parser.options.count("prune") > 0;
+      if (parser.options.count("reorder"))
+      {
+  std::string order = parser.option_argument("reorder");
+  if (order == "bfs")
+    m_options.reorder = graph::bfs_order;
+  else if (order == "rcm")
+    m_options.reorder = graph::rcm_order;
+  else if (order == "scc")
+    m_options.reorder = graph::scc_order;
+  else
+    parser.error("option --reorder has illegal argument '" + order + "'");
+      }
+      if (parser.options.count("mapping"))
+      {
+  m_options.mapping = true;
+  m_mapping_filename = parser.option_argument("mapping");
+      }
+      if (parser.options.count("mapping-format"))
+      {
+  std::string format = parser.option_argument("mapping-format");
+  if (format != "text" and format != "binary")
+    parser.error("option --mapping-format has illegal argument '" + format + "'");
+  m_binary_mapping = format == "binary";
+      }
+      if (parser.options.count("format"))
+      {
+  std::string format = parser.option_argument("format");
+  if (format != "pgsolver" and format != "binary")
+    parser.error("option --format has illegal argument '" + format + "'");
+  m_options.format = format == "binary" ? graph::pgbinary : graph::pgsolver;
+      }
+      if (parser.options.count("stats"))
+      {
+  m_options.statistics = true;
+  m_stats_filename = parser.option_argument("stats");
+      }
+      if (parser.options.count("trace"))
+  m_trace_filename = parser.option_argument("trace");
+      if (parser.options.count("max-memory"))
+      {
+  size_t limit = parser.option_argument_as<size_t>("max-memory");
+  if (limit == 0)
+    parser.error("option --max-memory requires a positive number.");
+  graph::memory::set_limit(limit << 20);
+      }
+      m_batch = parser.options.count("batch") > 0;
+      m_compare = parser.options.count("compare") > 0;
+      if (parser.options.count("query"))
+      {
+  std::stringstream vertices(parser.option_argument("query"));
+  char comma = 0;
+  unsigned long long v, w;
+  if (not (vertices >> v >> comma >> w) or comma != ',' or not vertices.eof()
+      or v > graph::max_vertices or w > graph::max_vertices)
+    parser.error("option --query has illegal argument '" + parser.option_argument("query") + "'");
+  m_query_vertices[0] = v;
+  m_query_vertices[1] = w;
+  m_query = true;
+      }
+      if (parser.options.count("query-with"))
+      {
+  if (m_query)
+    parser.error("option --query cannot be combined with --query-with.");
+  m_query_filename = parser.option_argument("query-with");
+  m_query = true;
+      }
+      if (parser.options.count("threads"))
+      {
+  m_threads = parser.option_argument_as<size_t>("threads");
+  if (m_threads == 0)
+    parser.error("option --threads requires a positive number.");
+      }
+      if (not m_batch and not m_compare)
+  m_options.threads = m_threads;
+      if (m_batch and m_options.mapping)
+  parser.error("option --mapping cannot be combined with --batch.");
+      if (m_compare and m_batch)
+  parser.error("option --compare cannot be combined with --batch.");
+      if (m_compare and (m_options.mapping or m_options.fixpoint))
+  parser.error("option --compare cannot be combined with --mapping or --fixpoint.");
+      if (m_compare and m_options.format != graph::pgsolver)
+  parser.error("option --format cannot be combined with --compare.");
+      if (m_query and (m_batch or m_compare or m_options.fixpoint or m_options.prune
+          or m_options.reorder != graph::original_order or m_options.mapping
+          or m_options.format != graph::pgsolver))
+  parser.error("options --query and --query-with cannot be combined with --batch, "
+      "--compare, --fixpoint, --prune, --reorder, --mapping or --format.");
+      if (m_query and (m_options.pipeline.size() != 1
+          or not Reducer<Stopwatch>::queries(m_options.pipeline[0])))
+  parser.error("options --query and --query-with require a single method: bisim, "
+      "fmib, stut or gstut.");
+      if ((m_batch or m_compare) and m_options.statistics)
+  parser.error("option --stats cannot be combined with --batch or --compare.");
+      if (m_batch and (m_input_filename.empty() or m_output_filename.empty()))
+  parser.error("option --batch requires both INFILE and OUTFILE.");
     }
 };
 
@@ -0,0 +1,286 @@
+#include "mapping.h"
+#include "solution.h"
+#include "parsers/pgbinary.h"
+#include "streams.h"
+
+#include "cppcli/input_output_tool.h"
+#include "cpplogging/logger.h"
+
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <memory>
+
+/**
+ * @class pglift
+ * @brief Tool class that lifts the solution of a reduced parity game to the original game.
+ */
+class pglift : public tools::input_output_tool
+{
+  private:
+    std::string m_mapping_filename; ///< Mapping written by pgconvert --mapping.
+    std::string m_game_filename; ///< The original (unreduced) game, if given.
+    InputFile m_input;
+    OutputFile m_output;
+  public:
+    typedef graph::KripkeStructure<graph::Vertex<graph::pg::Label> > game_t;
+    pglift() :
+        tools::input_output_tool(
+        // Tool name:
+            "pglift",
+            // Author:
+            "S. Cranen",
+            // Tool summary:
+            "Lifts the solution of a reduced parity game to the original game.",
+            // Tool description:
+            "Reads a PGSolver solution of a parity game that was reduced by "
+            "pgconvert, and writes the solution of the original game. The "
+            "mapping written by pgconvert --mapping relates the two games. "
+            "Winners are lifted from the mapping alone; strategies are lifted "
+            "only if the original game is given with --game.",
+            // Known issues:
+            "For reductions modulo (governed) stuttering equivalence, a strategy "
+            "move in the reduced game may correspond to a path in the original "
+            "game. Vertices that cannot move to the chosen block directly then "
+            "get a move that stays in their own block, which is not guaranteed "
+            "to be winning.")
+    {
+    }
+
+    std::istream&
+    open_input()
+    {
+      std::istream& instream = m_input.open(m_input_filename);
+      if (m_input_filename.empty())
+        m_input_filename = "standard input";
+      cpplog(cpplogging::verbose)
+        << "Reading from " << m_input_filename
+        << (m_input.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return instream;
+    }
+
+    std::ostream&
+    open_output()
+    {
+      std::ostream& outstream = m_output.open(m_output_filename);
+      if (m_output_filename.empty())
+        m_output_filename = "standard output";
+      cpplog(cpplogging::verbose)
+        << "Writing to " << m_output_filename
+        << (m_output.compression() != uncompressed ? " (compressed)" : "") << "." << std::endl;
+      return outstream;
+    }
+
+    /**
+     * @brief Reads the next vertex specification of a PGSolver game from @a s.
+     * @return @c false if there are no more vertices in @a s.
+     */
+    bool
+    next_vertex(std::istream& s, graph::VertexIndex& index, unsigned int& player,
+        std::vector<graph::VertexIndex>& succ)
+    {
+      std::string stmt;
+      while (std::getline(s, stmt, ';'))
+      {
+        // Vertex names may contain semicolons.
+        while (std::count(stmt.begin(), stmt.end(), '"') % 2 == 1 and s.good())
+        {
+          std::string rest;
+          std::getline(s, rest, ';');
+          stmt += ';' + rest;
+        }
+        std::string::size_type quote = stmt.find('"');
+        if (quote != std::string::npos)
+          stmt.erase(quote);
+        std::istringstream entry(stmt);
+        std::string first;
+        if (!(entry >> first) or first == "parity" or first == "start")
+          continue;
+        std::istringstream idx(first);
+        size_t prio;
+        idx >> index;
+        entry >> prio >> player;
+        if (idx.fail() or entry.fail())
+          throw std::runtime_error("Invalid vertex specification '" + stmt + "' in "
+                                   + m_game_filename + ".");
+        succ.clear();
+        graph::VertexIndex w;
+        char comma;
+        while (entry >> w)
+        {
+          succ.push_back(w);
+          entry >> comma;
+        }
+        return true;
+      }
+      return false;
+    }
+
+    /**
+     * @brief Writes the solution of vertex @a v of the original game, owned by
+     *   @a player and with successors @a succ, to @a out.
+     * @return @c false if @a v has no representative with a known winner.
+     */
+    bool
+    lift_vertex(const std::vector<graph::VertexIndex>& mapping,
+        const graph::pg::Solution& solution, graph::VertexIndex v, unsigned int player,
+        const std::vector<graph::VertexIndex>& succ, std::ostream& out)
+    {
+      const graph::VertexIndex none = graph::impl::removed;
+      if (v >= mapping.size())
+        throw std::runtime_error("Original game contains more vertices than the mapping.");
+      graph::VertexIndex b = mapping[v];
+      if (b == none or b >= solution.winner.size()
+          or solution.winner[b] == graph::pg::Solution::unknown)
+        return false;
+      unsigned char w = solution.winner[b];
+      graph::VertexIndex move = none;
+      if (player == w)
+      {
+        graph::VertexIndex target = solution.strategy[b];
+        for (size_t i = 0; i < succ.size() and move == none; ++i)
+          if (succ[i] < mapping.size() and mapping[succ[i]] == target)
+            move = succ[i];
+        for (size_t i = 0; i < succ.size() and move == none; ++i)
+          if (succ[i] < mapping.size() and mapping[succ[i]] == b)
+            move = succ[i];
+      }
+      graph::pg::Solution::dump_vertex(out, v, w, move);
+      return true;
+    }
+
+    /**
+     * @brief Writes the solution of the original game in @a game to @a out.
+     *
+     * A game in the PGSolver format is read in a single streaming pass. A game
+     * in the binary format (see Parser<Vertex, pgbinary>) is loaded first.
+     */
+    void
+    lift(const std::vector<graph::VertexIndex>& mapping,
+        const graph::pg::Solution& solution, std::istream& game, std::ostream& out)
+    {
+      std::vector<graph::VertexIndex> succ;
+      graph::VertexIndex v;
+      unsigned int player;
+      size_t unsolved = 0;
+      out << "paritysol " << mapping.size() - 1 << ";\n";
+      if (graph::Parser<game_t::vertex_t, graph::pgbinary>::recognise(game))
+      {
+        game_t pg;
+        graph::Parser<game_t::vertex_t, graph::pgbinary> parser(pg);
+        parser.load(game);
+        for (v = 0; v < pg.size(); ++v)
+        {
+          succ.assign(pg.vertex(v).out.begin(), pg.vertex(v).out.end());
+          if (not lift_vertex(mapping, solution, v, pg.vertex(v).label.player, succ, out))
+            ++unsolved;
+        }
+      }
+      else
+      {
+        while (next_vertex(game, v, player, succ))
+          if (not lift_vertex(mapping, solution, v, player, succ, out))
+            ++unsolved;
+      }
+      out << std::flush;
+      report(unsolved);
+    }
+
+    /// @brief Writes the winners of the original game to @a out, without strategies.
+    void
+    lift(const std::vector<graph::VertexIndex>& mapping,
+        const graph::pg::Solution& solution, std::ostream& out)
+    {
+      size_t unsolved = 0;
+      out << "paritysol " << mapping.size() - 1 << ";\n";
+      for (size_t v = 0; v < mapping.size(); ++v)
+      {
+        graph::VertexIndex b = mapping[v];
+        if (b == graph::impl::removed or b >= solution.winner.size()
+            or solution.winner[b] == graph::pg::Solution::unknown)
+          ++unsolved;
+        else
+          graph::pg::Solution::dump_vertex(out, v, solution.winner[b], graph::impl::removed);
+      }
+      out << std::flush;
+      report(unsolved);
+    }
+
+    void
+    report(size_t unsolved)
+    {
+      if (unsolved)
+        cpplog(cpplogging::warning)
+          << unsolved << " vertices have no representative with a known winner; "
+          << "they are omitted from the solution." << std::endl;
+    }
+
+    /// @brief Runs the tool (see tools::input_output_tool::run).
+    bool
+    run()
+    {
+      std::vector<graph::VertexIndex> mapping;
+      graph::pg::Solution solution;
+
+      timer().start("load mapping");
+      std::ifstream mapstream(m_mapping_filename.c_str(), std::ios::in | std::ios::binary);
+      if (!mapstream)
+        throw std::runtime_error("Could not open " + m_mapping_filename + ".");
+      graph::mapping::read(mapstream, mapping);
+      timer().finish("load mapping");
+      if (mapping.empty())
+        throw std::runtime_error("The mapping in " + m_mapping_filename + " is empty.");
+
+      std::istream& instream = open_input();
+      timer().start("load solution");
+      solution.load(instream);
+      timer().finish("load solution");
+      cpplog(cpplogging::verbose)
+        << "Lifting solution of " << solution.winner.size() << " vertices to "
+        << mapping.size() << " vertices." << std::endl;
+
+      std::ostream& outstream = open_output();
+      timer().start("lift");
+      if (m_game_filename.empty())
+        lift(mapping, solution, outstream);
+      else
+      {
+        InputFile game;
+        lift(mapping, solution, game.open(m_game_filename), outstream);
+      }
+      timer().finish("lift");
+      return true;
+    }
+  protected:
+    /// @brief Adds the --mapping and --game options (see tools::input_output_tool::add_options).
+    void
+    add_options(interface_description& desc)
+    {
+      tools::input_output_tool::add_options(desc);
+      desc.add_option("mapping", make_mandatory_argument("FILE"),
+          "Read the mapping from the original to the reduced game from FILE, "
+          "as written by pgconvert --mapping.", 'm');
+      desc.add_option("game", make_mandatory_argument("FILE"),
+          "Read the original game from FILE to lift strategies as well as winners. "
+          "The game may be in the PGSolver or the binary format.", 'g');
+    }
+    /// @brief Parses the --mapping and --game options (see tools::input_output_tool::parse_options).
+    void
+    parse_options(const command_line_parser& parser)
+    {
+      tools::input_output_tool::parse_options(parser);
+      if (parser.options.count("mapping"))
+        m_mapping_filename = parser.option_argument("mapping");
+      else
+        parser.error("please specify a mapping using the -m option.");
+      if (parser.options.count("game"))
+        m_game_filename = parser.option_argument("game");
+    }
+};
+
+int
+main(int argc, char** argv)
+{
+  return std::unique_ptr<pglift>(new pglift())->execute(argc, argv);
+}
@@ -0,0 +1,848 @@
+#ifndef __REDUCER_H
+#define __REDUCER_H
+
+#include "equivalence.h"
+#include "parsers/pgsolver.h"
+#include "parsers/pgbinary.h"
+#include "parsers/dot.h"
+#include "govstut.h"
+#include "wgovstut.h"
+#include "bisim.h"
+#include "fmib.h"
+#include "stut.h"
+#include "pg.h"
+#include "statistics.h"
+#include "trace.h"
+#include "memusage.h"
+
+#include "cpplogging/logger.h"
+
+#include <chrono>
+#include <sstream>
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief Records a duration that was measured outside of @a timer.
+ *
+ * Timers that only support @c start and @c finish ignore such durations; timers
+ * that can store them provide an overload of this function.
+ */
+template<typename Timer>
+inline void
+record_duration(Timer&, const std::string&, double)
+{
+}
+
+/**
+ * @brief Settings that determine how a Reducer treats a parity game.
+ */
+struct ReductionOptions
+{
+  ReductionOptions() :
+    fixpoint(false), prune(false), reorder(graph::original_order), mapping(false),
+    statistics(false), threads(1), format(graph::pgsolver), release(true) {}
+  std::vector<Equivalence> pipeline; ///< The reductions to apply, in order.
+  bool fixpoint; ///< Repeat the pipeline until the game no longer shrinks.
+  bool prune; ///< Remove vertices that are unreachable from vertex 0 first.
+  graph::VertexOrder reorder; ///< Renumber the vertices in this order before reducing.
+  bool mapping; ///< Track which vertex of the result represents each input vertex.
+  bool statistics; ///< Record the counters of every partitioner (see Reducer::statistics).
+  size_t threads; ///< The number of threads a single reduction may use.
+  graph::FileFormat format; ///< The format in which games are written: pgsolver or pgbinary.
+  bool release; ///< Return the node pool to the global allocator once run() has freed the game; only if no other Reducer runs concurrently.
+};
+
+/**
+ * @class Reducer
+ * @brief Loads, reduces and saves a single parity game.
+ *
+ * Phase timings are recorded through @a Timer, which must provide
+ * @c start(name) and @c finish(name); every phase is also recorded as a span
+ * in the trace if tracing is enabled (see graph::trace). The time that loading and saving spend
+ * waiting for I/O is passed to record_duration and logged. A Reducer does not share any state with
+ * other instances, so several games can be reduced concurrently as long as
+ * each uses its own Reducer and Timer.
+ */
+template<typename Timer>
+class Reducer
+{
+  public:
+    typedef graph::KripkeStructure<graph::Vertex<graph::pg::DivLabel> > game_t;
+
+    /**
+     * @brief Constructor.
+     * @param timer The timer that records the phases of the reduction.
+     * @param options Determines which reductions are applied.
+     */
+    Reducer(Timer& timer, const ReductionOptions& options) :
+      m_timer(timer), m_options(options), m_stream(NULL)
+    {
+    }
+
+    template<typename graph_t, typename partitioner_t>
+    void dump_dot(graph_t& graph, partitioner_t& partitioner)
+    {
+      typedef typename graph_t::vertex_t vertex_t;
+      graph::pg::VertexFormatter<vertex_t> fmt;
+      graph::Parser<vertex_t, graph::dot> p(graph, fmt);
+      p.dump(std::cout, partitioner);
+    }
+
+    /**
+     * @brief Collapses the SCCs of @a graph (see graph::KripkeStructure::collapse_sccs).
+     * @param index If given, receives the new index of every vertex.
+     */
+    template<typename graph_t>
+    void
+    collapse_sccs(graph_t& graph, std::vector<graph::VertexIndex>* index = NULL)
+    {
+      std::vector<graph::VertexIndex> own;
+      if (index == NULL and m_options.mapping)
+        index = &own;
+      start(phase("scc reduction"));
+      graph.collapse_sccs(index);
+      finish(phase("scc reduction"));
+      if (index)
+        remap(*index);
+      cpplog(cpplogging::verbose)
+  << "Parity game contains " << graph.size() << " nodes and "
+      << graph.num_edges() << " edges after SCC reduction."
+      << std::endl;
+    }
+
+    template<typename graph_t>
+    void
+    encode_divergence(graph_t& pg)
+    {
+      graph::trace::span span("encode divergence");
+      pg.resize(pg.size() + 1);
+      typename graph_t::vertex_t& divmark = pg.vertex(pg.size() - 1);
+      // The marker gets a priority that no other vertex has, so that partitioners
+      // that ignore the div flag never put it in a block with other vertices.
+      divmark.label.prio = 0;
+      divmark.label.player = graph::pg::even;
+      divmark.label.div = true;
+      for (size_t i = 0; i < pg.size() - 1; ++i)
+      {
+  typename graph_t::vertex_t& v = pg.vertex(i);
+  if (v.label.prio >= divmark.label.prio)
+    divmark.label.prio = v.label.prio + 1;
+  if (v.label.div)
+  {
+    v.out.insert(pg.size() - 1);
+    divmark.in.insert(i);
+    v.label.div = false;
+  }
+      }
+    }
+
+    template<typename graph_t>
+    void
+    decode_divergence(graph_t& pg)
+    {
+      graph::trace::span span("decode divergence");
+      size_t div = 0;
+      for (size_t i = 0; i < pg.size(); ++i)
+      {
+  if (pg.vertex(i).label.div)
+  {
+    div = i;
+    typename graph_t::vertex_t& v = pg.vertex(div);
+    for (graph::VertexSet::iterator j = v.in.begin(); j != v.in.end();
+        ++j)
+        {
+      pg.vertex(*j).out.erase(i);
+      pg.vertex(*j).out.insert(*j);
+      pg.vertex(*j).in.insert(*j);
+    }
+    pg.vertex(i).in.clear();
+  }
+      }
+      for (size_t i = 0; i < pg.size(); ++i)
+      {
+  graph::VertexSet in, out;
+  for (graph::VertexSet::iterator it = pg.vertex(i).in.begin();
+      it != pg.vertex(i).in.end(); ++it)
+    in.insert(*it - (*it > div ? 1 : 0));
+  for (graph::VertexSet::iterator it = pg.vertex(i).out.begin();
+      it != pg.vertex(i).out.end(); ++it)
+    out.insert(*it - (*it > div ? 1 : 0));
+  pg.vertex(i).in.swap(in);
+  pg.vertex(i).out.swap(out);
+  if (i > div)
+    pg.vertex(i - 1) = pg.vertex(i);
+      }
+      pg.resize(pg.size() - 1);
+      remap([div](graph::VertexIndex v)
+      {
+        return v == div ? graph::impl::removed : v > div ? v - 1 : v;
+      });
+      cpplog(cpplogging::verbose)
+  << "Parity game contains " << pg.size() << " nodes and "
+      << pg.num_edges() << " edges after restoring divergences."
+      << std::endl;
+    }
+
+    /**
+     * @brief Partitions a graph with @a partitioner and, if @a output is given,
+     *   stores the quotient in it; if run() asked for it, the quotient is
+     *   written to the output stream instead (see stream()).
+     * @param input If given, the partitioned graph, whose edges are freed while
+     *   the quotient is built (see graph::Partitioner::store_quotient).
+     */
+    template<typename partitioner_t, typename graph_t>
+    void
+    partition(Equivalence e, partitioner_t& partitioner, graph_t* output =
+  NULL, graph_t* input = NULL)
+    {
+      partitioner.set_threads(m_options.threads);
+      start(phase("partition refinement"));
+      partitioner.partition();
+      finish(phase("partition refinement"));
+      record(e.name(), partitioner);
+      if (m_stream)
+      {
+  if (m_options.format == graph::pgbinary)
+    stream<graph::pgbinary>(e, partitioner, input);
+  else
+    stream<graph::pgsolver>(e, partitioner, input);
+      }
+      else if (output)
+      {
+  start(phase("quotient"));
+  if (input)
+    partitioner.store_quotient(*output, *input);
+  else
+    partitioner.store_quotient(*output);
+  finish(phase("quotient"));
+  remap([&partitioner](graph::VertexIndex v) { return partitioner.block_index(v); });
+  cpplog(cpplogging::verbose)
+    << "Parity game contains " << output->size() << " nodes and "
+        << output->num_edges() << " edges after " << e.desc()
+        << " reduction." << std::endl;
+      }
+    }
+
+    /**
+     * @brief Writes the quotient computed by @a partitioner to the stream given
+     *   to run(), in @a format, without storing it first.
+     * @param input If given, the partitioned graph, whose edges are freed while
+     *   the quotient is written.
+     */
+    template<graph::FileFormat format, typename partitioner_t, typename graph_t>
+    void
+    stream(Equivalence e, partitioner_t& partitioner, graph_t* input)
+    {
+      start(phase("quotient"));
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      graph::VertexWriter<format> writer(*m_stream);
+      m_stream = NULL;
+      if (input)
+  partitioner.stream_quotient(writer, *input);
+      else
+  partitioner.stream_quotient(writer);
+      finish(phase("quotient"));
+      io_wait(phase("quotient"), "quotienting", start, writer.wait_time());
+      remap([&partitioner](graph::VertexIndex v) { return partitioner.block_index(v); });
+      cpplog(cpplogging::verbose)
+  << "Wrote parity game with " << writer.size() << " nodes and "
+      << writer.edges() << " edges after " << e.desc()
+      << " reduction." << std::endl;
+    }
+
+    /**
+     * @brief Reads a game in PGSolver or binary format (see graph::pgbinary_format)
+     *   from @a s; the format is recognised by the first character.
+     * @param name The name of the phase, which must differ for every game that
+     *   is loaded.
+     */
+    template<typename graph_t>
+    void
+    load(graph_t& graph, std::istream& s, const std::string& name = "load")
+    {
+      cpplog(cpplogging::verbose)
+  << "Loading parity game." << std::endl;
+      start(name);
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      double wait;
+      if (graph::Parser<typename graph_t::vertex_t, graph::pgbinary>::recognise(s))
+      {
+        graph::Parser<typename graph_t::vertex_t, graph::pgbinary> parser(graph);
+        parser.load(s);
+        wait = parser.wait_time();
+      }
+      else
+      {
+        graph::Parser<typename graph_t::vertex_t, graph::pgsolver> parser(graph);
+        parser.load(s);
+        wait = parser.wait_time();
+      }
+      finish(name);
+      io_wait(name, "parse", start, wait);
+      cpplog(cpplogging::verbose)
+  << "Parity game contains " << graph.size() << " nodes and "
+      << graph.num_edges() << " edges." << std::endl;
+    }
+
+    /// @brief Writes @a graph to @a s in the format given by the @c format option.
+    template<typename graph_t>
+    void
+    save(graph_t& graph, std::ostream& s)
+    {
+      start("save");
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      double wait;
+      if (m_options.format == graph::pgbinary)
+      {
+        graph::Parser<typename graph_t::vertex_t, graph::pgbinary> parser(graph);
+        parser.dump(s);
+        wait = parser.wait_time();
+      }
+      else
+      {
+        graph::Parser<typename graph_t::vertex_t, graph::pgsolver> parser(
+      graph);
+        parser.dump(s, m_options.threads);
+        wait = parser.wait_time();
+      }
+      finish("save");
+      io_wait("save", "format", start, wait);
+    }
+
+    /**
+     * @brief Reports which part of the I/O phase @a name, which began at @a start,
+     *   was spent waiting for I/O, and which part on @a work.
+     */
+    void
+    io_wait(const std::string& name, const std::string& work,
+      std::chrono::steady_clock::time_point start, double wait)
+    {
+      double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      record_duration(m_timer, name + " (" + work + ")", total - wait);
+      record_duration(m_timer, name + " (I/O wait)", wait);
+      cpplog(cpplogging::verbose)
+  << "Spent " << total - wait << "s on " << work << " and " << wait
+      << "s waiting for I/O during " << name << "." << std::endl;
+    }
+
+    /**
+     * @brief Moves the vertices of @a src into @a dst.
+     *
+     * The adjacency sets are swapped rather than copied, so handing a game from one
+     * reduction stage to the next costs time linear in the number of vertices only.
+     * Only the priority and player of each label are transferred. @a src is left empty.
+     */
+    template<typename src_graph_t, typename dst_graph_t>
+    void
+    transfer(src_graph_t& src, dst_graph_t& dst)
+    {
+      dst.resize(0);
+      dst.resize(src.size());
+      for (size_t i = 0; i < src.size(); ++i)
+      {
+        typename src_graph_t::vertex_t& v = src.vertex(i);
+        typename dst_graph_t::vertex_t& w = dst.vertex(i);
+        w.label.prio = v.label.prio;
+        w.label.player = (graph::pg::Player)v.label.player;
+        w.out.swap(v.out);
+        w.in.swap(v.in);
+      }
+      src.resize(0);
+    }
+
+    /**
+     * @brief Returns the vertex mapping computed by the last call to run().
+     * @details Entry @e v holds the index of the vertex in the reduced game
+     *   that represents vertex @e v of the game that was passed to run(), or
+     *   graph::impl::removed if no vertex represents it. Only available if the
+     *   @c mapping option was set.
+     */
+    const std::vector<graph::VertexIndex>&
+    mapping() const
+    {
+      return m_mapping;
+    }
+
+    /**
+     * @brief Returns the statistics of every partitioner that ran since the
+     *   Reducer was constructed, in order. Only available if the @c statistics
+     *   option was set.
+     */
+    const std::vector<ReductionStatistics>&
+    statistics() const
+    {
+      return m_statistics;
+    }
+
+    /**
+     * @brief Records the statistics of @a partitioner, which has just computed a
+     *   partition for @a reduction, if the @c statistics option was set.
+     */
+    template<typename partitioner_t>
+    void
+    record(const std::string& reduction, const partitioner_t& partitioner)
+    {
+      if (not m_options.statistics)
+        return;
+      ReductionStatistics r;
+      r.reduction = reduction;
+      if (not m_stage.empty())
+        r.stage = m_stage.substr(2, m_stage.size() - 3);
+      r.nodes = partitioner.graph().size();
+      r.edges = partitioner.graph().num_edges();
+      r.counters = partitioner.statistics();
+      r.block_sizes = partitioner.block_size_histogram();
+      for (size_t i = 0; i < r.block_sizes.size(); ++i)
+        r.blocks += r.block_sizes[i];
+      m_statistics.push_back(r);
+    }
+
+    /// @brief Replaces every tracked representative @e v by @a f(@e v).
+    template<typename Function>
+    void
+    remap(Function f)
+    {
+      if (not m_options.mapping)
+        return;
+      for (size_t i = 0; i < m_mapping.size(); ++i)
+        if (m_mapping[i] != graph::impl::removed)
+          m_mapping[i] = f(m_mapping[i]);
+    }
+
+    /// @brief Replaces every tracked representative @e v by @a index[@e v].
+    void
+    remap(const std::vector<graph::VertexIndex>& index)
+    {
+      remap([&index](graph::VertexIndex v) { return index[v]; });
+    }
+
+    /**
+     * @brief Starts timing phase @a name, and its span in the trace (see graph::trace).
+     * @throws graph::memory::limit_exceeded if the memory limit has already been exceeded.
+     */
+    void
+    start(const std::string& name)
+    {
+      graph::memory::check("the start of " + name);
+      m_timer.start(name);
+      graph::trace::begin(name);
+    }
+
+    /**
+     * @brief Finishes timing phase @a name, and its span in the trace, and
+     *   reports the memory in use (see graph::memory).
+     * @throws graph::memory::limit_exceeded if the memory limit was exceeded.
+     */
+    void
+    finish(const std::string& name)
+    {
+      graph::trace::end(name);
+      m_timer.finish(name);
+      cpplog(cpplogging::verbose)
+        << "Memory after " << name << ": " << graph::memory::summary() << "."
+        << std::endl;
+      graph::memory::check(name);
+    }
+
+    /// @brief Returns the name of timing @a name, qualified with the current stage.
+    std::string
+    phase(const std::string& name) const
+    {
+      return name + m_stage;
+    }
+
+    void
+    reduce_scc(game_t& pg)
+    {
+      collapse_sccs(pg);
+      for (size_t i = 0; i < pg.size(); ++i)
+      {
+        if (pg.vertex(i).label.div)
+        {
+          pg.vertex(i).out.insert(i);
+          pg.vertex(i).in.insert(i);
+          pg.vertex(i).label.div = false;
+        }
+      }
+    }
+
+    void
+    reduce_bisim(game_t& game)
+    {
+      typedef graph::BisimulationPartitioner<graph::pg::DivLabel>::graph_t graph_t;
+      graph_t pg;
+      graph_t output;
+      graph::BisimulationPartitioner<graph::pg::DivLabel> p(pg);
+      transfer(game, pg);
+      partition(Equivalence::bisim, p, &output, &pg);
+      transfer(output, game);
+    }
+
+    void
+    reduce_fmib(game_t& game)
+    {
+      typedef graph::pg::FMIBPartitioner<graph::pg::DivLabel>::graph_t graph_t;
+      graph_t pg;
+      graph_t output;
+      graph::pg::FMIBPartitioner<graph::pg::DivLabel> p(pg);
+      transfer(game, pg);
+      partition(Equivalence::fmib, p, &output, &pg);
+      transfer(output, game);
+    }
+
+    void
+    reduce_stut(game_t& game)
+    {
+      typedef graph::StutteringPartitioner<graph::pg::DivLabel>::graph_t graph_t;
+      graph_t pg;
+      graph_t output;
+      graph::StutteringPartitioner<graph::pg::DivLabel> p(pg);
+      transfer(game, pg);
+      collapse_sccs(pg);
+      encode_divergence(pg);
+      partition(Equivalence::stut, p, &output, &pg);
+      decode_divergence(output);
+      transfer(output, game);
+    }
+
+    void
+    reduce_gstut(game_t& game)
+    {
+      typedef graph::pg::GovernedStutteringPartitioner<graph::pg::Label>::graph_t graph_t;
+      graph_t pg;
+      graph_t output;
+      graph::pg::GovernedStutteringPartitioner<graph::pg::Label> p(pg);
+      transfer(game, pg);
+      partition(Equivalence::gstut, p, &output, &pg);
+      transfer(output, game);
+    }
+
+    void
+    reduce_scc_gstut(game_t& game)
+    {
+      typedef graph::pg::GovernedStutteringPartitioner<graph::pg::DivLabel>::graph_t graph_t;
+      graph_t pg;
+      graph_t output;
+      graph::pg::GovernedStutteringPartitioner<graph::pg::DivLabel> p(pg);
+      transfer(game, pg);
+      collapse_sccs(pg);
+      encode_divergence(pg);
+      partition(Equivalence::scc_gstut, p, &output, &pg);
+      decode_divergence(output);
+      transfer(output, game);
+    }
+
+    void
+    reduce_wgstut(game_t& game)
+    {
+      typedef graph::pg::GovernedStutteringPartitioner<graph::pg::Label>::graph_t graph_t;
+      graph_t pg1;
+      graph_t pg2;
+      graph::pg::ParadisePartitioner<graph::pg::Label> pp(pg1);
+      graph::pg::GovernedStutteringPartitioner<graph::pg::Label> gsp(pg2);
+      transfer(game, pg1);
+      pp.set_threads(m_options.threads);
+      start(phase("paradise reduction"));
+      pp.partition();
+      record("paradise", pp);
+      pp.store_quotient(pg2, pg1);
+      finish(phase("paradise reduction"));
+      remap([&pp](graph::VertexIndex v) { return pp.block_index(v); });
+      pg1.resize(0);
+      partition(Equivalence::wgstut, gsp, &pg1, &pg2);
+      transfer(pg1, game);
+    }
+
+    /// @brief Applies the reduction for equivalence @a e to @a game.
+    void
+    reduce(Equivalence e, game_t& game)
+    {
+      if (e == Equivalence::scc)
+        reduce_scc(game);
+      else if (e == Equivalence::bisim)
+        reduce_bisim(game);
+      else if (e == Equivalence::fmib)
+        reduce_fmib(game);
+      else if (e == Equivalence::stut)
+        reduce_stut(game);
+      else if (e == Equivalence::gstut)
+        reduce_gstut(game);
+      else if (e == Equivalence::scc_gstut)
+        reduce_scc_gstut(game);
+      else if (e == Equivalence::wgstut)
+        reduce_wgstut(game);
+    }
+
+    /**
+     * @brief Stores the quotient of @a game modulo @a e in @a result.
+     *
+     * Unlike reduce(), this leaves @a game unchanged, so several quotients can be
+     * computed from one game at the same time. The bisim, fmib, gstut and wgstut
+     * partitioners only read @a game; the reductions that collapse SCCs first
+     * change the game, and therefore work on a copy.
+     */
+    void
+    quotient(Equivalence e, const game_t& game, game_t& result)
+    {
+      if (e == Equivalence::bisim)
+      {
+        graph::BisimulationPartitioner<graph::pg::DivLabel> p(game);
+        partition(e, p, &result);
+      }
+      else if (e == Equivalence::fmib)
+      {
+        graph::pg::FMIBPartitioner<graph::pg::DivLabel> p(game);
+        partition(e, p, &result);
+      }
+      else if (e == Equivalence::gstut)
+      {
+        graph::pg::GovernedStutteringPartitioner<graph::pg::DivLabel> p(game);
+        partition(e, p, &result);
+      }
+      else if (e == Equivalence::wgstut)
+      {
+        game_t paradise;
+        graph::pg::ParadisePartitioner<graph::pg::DivLabel> pp(game);
+        pp.set_threads(m_options.threads);
+        start(phase("paradise reduction"));
+        pp.partition(&paradise);
+        finish(phase("paradise reduction"));
+        record("paradise", pp);
+        remap([&pp](graph::VertexIndex v) { return pp.block_index(v); });
+        graph::pg::GovernedStutteringPartitioner<graph::pg::DivLabel> p(paradise);
+        partition(e, p, &result);
+      }
+      else
+      {
+        result = game;
+        reduce(e, result);
+      }
+    }
+
+    /**
+     * @brief Partitions a graph with @a partitioner until vertices @a v and @a w
+     *   are separated or the partition is stable, and returns whether they
+     *   ended up in the same block. No quotient is computed.
+     */
+    template<typename partitioner_t>
+    bool
+    decide(Equivalence e, partitioner_t& partitioner, graph::VertexIndex v, graph::VertexIndex w)
+    {
+      partitioner.stop_when_separated(v, w);
+      start(phase("partition refinement"));
+      partitioner.partition();
+      finish(phase("partition refinement"));
+      record(e.name(), partitioner);
+      bool result = partitioner.block_index(v) == partitioner.block_index(w);
+      cpplog(cpplogging::verbose)
+        << "Decided after " << partitioner.statistics().rounds
+        << " rounds of partition refinement for " << e.desc() << "." << std::endl;
+      return result;
+    }
+
+    /**
+     * @brief Returns whether vertices @a v and @a w of @a game are equivalent
+     *   modulo @a e, which must be one of the equivalences for which queries()
+     *   holds.
+     *
+     * Refinement stops as soon as @a v and @a w are in different blocks, so a
+     * negative answer usually costs only part of a reduction, and no quotient
+     * is computed either way. Like reduce(), this takes the vertices of
+     * @a game, which is left empty.
+     */
+    bool
+    equivalent(Equivalence e, game_t& game, graph::VertexIndex v, graph::VertexIndex w)
+    {
+      if (e == Equivalence::bisim)
+      {
+        typedef graph::BisimulationPartitioner<graph::pg::DivLabel>::graph_t graph_t;
+        graph_t pg;
+        graph::BisimulationPartitioner<graph::pg::DivLabel> p(pg);
+        transfer(game, pg);
+        return decide(e, p, v, w);
+      }
+      else if (e == Equivalence::fmib)
+      {
+        typedef graph::pg::FMIBPartitioner<graph::pg::DivLabel>::graph_t graph_t;
+        graph_t pg;
+        graph::pg::FMIBPartitioner<graph::pg::DivLabel> p(pg);
+        transfer(game, pg);
+        return decide(e, p, v, w);
+      }
+      else if (e == Equivalence::stut)
+      {
+        typedef graph::StutteringPartitioner<graph::pg::DivLabel>::graph_t graph_t;
+        graph_t pg;
+        graph::StutteringPartitioner<graph::pg::DivLabel> p(pg);
+        std::vector<graph::VertexIndex> index;
+        transfer(game, pg);
+        collapse_sccs(pg, &index);
+        v = index[v];
+        w = index[w];
+        if (v == w)
+          return true;
+        encode_divergence(pg);
+        return decide(e, p, v, w);
+      }
+      else if (e == Equivalence::gstut)
+      {
+        typedef graph::pg::GovernedStutteringPartitioner<graph::pg::Label>::graph_t graph_t;
+        graph_t pg;
+        graph::pg::GovernedStutteringPartitioner<graph::pg::Label> p(pg);
+        transfer(game, pg);
+        return decide(e, p, v, w);
+      }
+      throw std::runtime_error("Equivalence queries are not supported for " + e.desc() + ".");
+    }
+
+    /**
+     * @brief Returns whether equivalent() can decide @a e: the reductions that
+     *   compute a single partition of the game, possibly after collapsing SCCs.
+     */
+    static bool
+    queries(Equivalence e)
+    {
+      return e == Equivalence::bisim or e == Equivalence::fmib
+          or e == Equivalence::stut or e == Equivalence::gstut;
+    }
+
+    /// @brief Removes the vertices of @a game that are unreachable from vertex 0.
+    void
+    prune(game_t& game)
+    {
+      size_t size = game.size();
+      std::vector<graph::VertexIndex> index;
+      start("reachability pruning");
+      size_t removed = game.prune_unreachable(m_options.threads,
+          m_options.mapping ? &index : NULL);
+      finish("reachability pruning");
+      remap(index);
+      cpplog(cpplogging::verbose)
+        << "Pruned " << removed << " of " << size
+        << " nodes that are unreachable from node 0; parity game contains "
+        << game.size() << " nodes and " << game.num_edges() << " edges."
+        << std::endl;
+    }
+
+    /**
+     * @brief Renumbers the vertices of @a game in the order given by the
+     *   @c reorder option. Vertex 0 keeps its index.
+     */
+    void
+    reorder(game_t& game)
+    {
+      std::vector<graph::VertexIndex> index;
+      start("reordering");
+      game.reorder(m_options.reorder, m_options.threads, m_options.mapping ? &index : NULL);
+      finish("reordering");
+      remap(index);
+    }
+
+    /**
+     * @brief Applies every reduction in the pipeline to @a game, in order.
+     *
+     * If requested, unreachable vertices are removed and the remaining ones are
+     * renumbered (see reorder()) first, and the vertex that
+     * represents each vertex of @a game is tracked (see mapping()). If --fixpoint was
+     * given, the pipeline is repeated until a round neither
+     * reduces the number of vertices nor the number of edges.
+     *
+     * If @a output is given, the result is written to it (see save()). If the
+     * last reduction computes a quotient that needs no further processing,
+     * that quotient is then written while it is computed, without storing it.
+     * Either way, @a game is left empty, and the memory of its adjacency sets
+     * is returned to the global allocator (see teardown()).
+     */
+    void
+    run(game_t& game, std::ostream* output = NULL)
+    {
+      if (m_options.mapping)
+      {
+        m_mapping.resize(game.size());
+        for (size_t i = 0; i < m_mapping.size(); ++i)
+          m_mapping[i] = i;
+      }
+      if (m_options.prune)
+        prune(game);
+      if (m_options.reorder != graph::original_order)
+        reorder(game);
+      bool qualify = m_options.pipeline.size() > 1 or m_options.fixpoint;
+      bool direct = output and not m_options.fixpoint and streams(m_options.pipeline.back());
+      size_t round = 1;
+      size_t size, edges;
+      do
+      {
+        size = game.size();
+        edges = game.num_edges();
+        for (size_t stage = 0; stage < m_options.pipeline.size(); ++stage)
+        {
+          Equivalence e = m_options.pipeline[stage];
+          if (qualify)
+          {
+            std::stringstream name;
+            name << " (round " << round << ", stage " << stage + 1 << ": "
+                 << e.name() << ")";
+            m_stage = name.str();
+          }
+          cpplog(cpplogging::verbose)
+            << "Performing " << e.desc() << " reduction" << m_stage << "."
+            << std::endl;
+          bool streamed = direct and stage + 1 == m_options.pipeline.size();
+          if (streamed)
+            m_stream = output;
+          start(phase("reduction"));
+          reduce(e, game);
+          finish(phase("reduction"));
+          if (qualify and not streamed)
+            cpplog(cpplogging::verbose)
+              << "Parity game contains " << game.size() << " nodes and "
+              << game.num_edges() << " edges after " << e.desc()
+              << " reduction" << m_stage << "." << std::endl;
+        }
+        ++round;
+      }
+      while (m_options.fixpoint and (game.size() < size or game.num_edges() < edges));
+      m_stage.clear();
+      if (output and not direct)
+        save(game, *output);
+      if (output)
+        teardown(game);
+    }
+
+    /**
+     * @brief Frees @a game and, if the @c release option is set, returns the
+     *   node pool to the global allocator (see graph::memory::release), which succeeds
+     *   if no other graph is alive.
+     */
+    void
+    teardown(game_t& game)
+    {
+      start("teardown");
+      game.resize(0);
+      if (m_options.release)
+        graph::memory::release();
+      finish("teardown");
+    }
+
+    /**
+     * @brief Returns whether the reduction for @a e can write its quotient while
+     *   computing it (see stream()); the others post-process their quotient.
+     */
+    static bool
+    streams(Equivalence e)
+    {
+      return e == Equivalence::bisim or e == Equivalence::fmib
+          or e == Equivalence::gstut or e == Equivalence::wgstut;
+    }
+
+  private:
+    Timer& m_timer;
+    ReductionOptions m_options;
+    std::vector<graph::VertexIndex> m_mapping; ///< Representative of every vertex of the input.
+    std::vector<ReductionStatistics> m_statistics; ///< See statistics().
+    std::string m_stage; ///< Suffix identifying the current stage in timings and messages.
+    std::ostream* m_stream; ///< If set, partition() writes the next quotient to it (see stream()).
+};
+
+#endif // __REDUCER_H
@@ -0,0 +1,87 @@
+#ifndef __STATISTICS_H
+#define __STATISTICS_H
+
+#include "partitioner.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The statistics of a single run of a partitioner.
+ */
+struct ReductionStatistics
+{
+  ReductionStatistics() : nodes(0), edges(0), blocks(0) {}
+  std::string reduction; ///< The equivalence, or the auxiliary partitioner (e.g. paradise).
+  std::string stage; ///< The round and stage of the pipeline; empty for a single reduction.
+  size_t nodes; ///< The number of vertices of the partitioned graph.
+  size_t edges; ///< The number of edges of the partitioned graph.
+  size_t blocks; ///< The number of blocks of the final partition.
+  graph::PartitionerStatistics counters;
+  std::vector<size_t> block_sizes; ///< See graph::Partitioner::block_size_histogram().
+};
+
+/// @brief Writes @a s to @a out as a JSON string literal.
+inline void
+write_json_string(std::ostream& out, const std::string& s)
+{
+  static const char* hex = "0123456789abcdef";
+  out << '"';
+  for (std::string::const_iterator c = s.begin(); c != s.end(); ++c)
+  {
+    if (*c == '"' or *c == '\\')
+      out << '\\' << *c;
+    else if ((unsigned char)*c < 0x20)
+      out << "\\u00" << hex[(*c >> 4) & 0xf] << hex[*c & 0xf];
+    else
+      out << *c;
+  }
+  out << '"';
+}
+
+/**
+ * @brief Writes the statistics of the reduction of @a input to @a out as a JSON
+ *   object.
+ *
+ * The object has an @c input member and a @c reductions array that contains one
+ * object per run of a partitioner, in the order in which they ran. Entry @e i
+ * of @c block_sizes counts the blocks with at least 2^@e i and less than
+ * 2^(@e i + 1) vertices.
+ */
+inline void
+write_statistics(std::ostream& out, const std::string& input,
+    const std::vector<ReductionStatistics>& statistics)
+{
+  out << "{\n  \"input\": ";
+  write_json_string(out, input);
+  out << ",\n  \"reductions\": [";
+  for (size_t i = 0; i < statistics.size(); ++i)
+  {
+    const ReductionStatistics& r = statistics[i];
+    const graph::PartitionerStatistics& c = r.counters;
+    out << (i ? ",\n" : "\n") << "    {\n      \"reduction\": ";
+    write_json_string(out, r.reduction);
+    out << ",\n      \"stage\": ";
+    write_json_string(out, r.stage);
+    out << ",\n      \"nodes\": " << r.nodes
+        << ",\n      \"edges\": " << r.edges
+        << ",\n      \"blocks\": " << r.blocks
+        << ",\n      \"rounds\": " << c.rounds
+        << ",\n      \"self_split_attempts\": " << c.self_split_attempts
+        << ",\n      \"self_splits\": " << c.self_splits
+        << ",\n      \"splitter_split_attempts\": " << c.splitter_split_attempts
+        << ",\n      \"splitter_splits\": " << c.splitter_splits
+        << ",\n      \"refinements\": " << c.refinements
+        << ",\n      \"vertices_moved\": " << c.vertices_moved
+        << ",\n      \"update_edges\": " << c.update_edges
+        << ",\n      \"attractor_visits\": " << c.attractor_visits
+        << ",\n      \"block_sizes\": [";
+    for (size_t b = 0; b < r.block_sizes.size(); ++b)
+      out << (b ? ", " : "") << r.block_sizes[b];
+    out << "]\n    }";
+  }
+  out << (statistics.empty() ? "]\n}\n" : "\n  ]\n}\n") << std::flush;
+}
+
+#endif // __STATISTICS_H
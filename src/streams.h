@@ -0,0 +1,221 @@
+#ifndef __STREAMS_H
+#define __STREAMS_H
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/lzma.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Compression formats that are recognised by InputFile and OutputFile.
+ */
+enum Compression
+{
+  uncompressed,
+  gzip,
+  zstd,
+  xz
+};
+
+/// @brief Returns the compression format whose magic number starts @a data.
+inline Compression
+compression_by_magic(const char* data, size_t size)
+{
+  static const struct { Compression format; const char* magic; size_t size; } formats[] =
+  {
+    { gzip, "\x1f\x8b", 2 },
+    { zstd, "\x28\xb5\x2f\xfd", 4 },
+    { xz, "\xfd" "7zXZ\x00", 6 }
+  };
+  for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+    if (size >= formats[i].size and std::memcmp(data, formats[i].magic, formats[i].size) == 0)
+      return formats[i].format;
+  return uncompressed;
+}
+
+/// @brief Returns the compression format that belongs to the extension of @a filename.
+inline Compression
+compression_by_extension(const std::string& filename)
+{
+  static const struct { Compression format; const char* extension; } formats[] =
+  {
+    { gzip, ".gz" },
+    { zstd, ".zst" },
+    { xz, ".xz" }
+  };
+  for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+  {
+    size_t n = std::strlen(formats[i].extension);
+    if (filename.size() > n and filename.compare(filename.size() - n, n, formats[i].extension) == 0)
+      return formats[i].format;
+  }
+  return uncompressed;
+}
+
+/**
+ * @class InputFile
+ * @brief Opens a file or standard input for reading.
+ *
+ * Input that is compressed with gzip, zstd or xz is recognised by its magic
+ * number and decompressed while it is being read. The parsers read ahead on a
+ * background thread (see graph::impl::InputReader), so decompression overlaps
+ * with parsing.
+ */
+class InputFile
+{
+  public:
+    InputFile() : m_compression(uncompressed), m_stream(NULL) {}
+    /**
+     * @brief Opens @a filename, or standard input if @a filename is empty.
+     * @return The stream from which the (decompressed) contents can be read.
+     */
+    std::istream&
+    open(const std::string& filename)
+    {
+      std::istream* raw = &std::cin;
+      if (not filename.empty())
+      {
+        m_file.reset(new std::ifstream(filename.c_str(), std::ios::in | std::ios::binary));
+        if (!*m_file)
+          throw std::runtime_error("Could not open " + filename + ".");
+        raw = m_file.get();
+      }
+      char magic[6];
+      raw->read(magic, sizeof(magic));
+      std::streamsize n = raw->gcount();
+      m_compression = compression_by_magic(magic, n);
+      if (m_compression == uncompressed and m_file.get() and n > 0)
+      {
+        m_file->clear();
+        m_file->seekg(0, std::ios::beg);
+        m_stream = raw;
+        return *m_stream;
+      }
+      m_filter.reset(new boost::iostreams::filtering_istream());
+      switch (m_compression)
+      {
+        case gzip:
+          m_filter->push(boost::iostreams::gzip_decompressor());
+          break;
+        case zstd:
+          m_filter->push(boost::iostreams::zstd_decompressor());
+          break;
+        case xz:
+          m_filter->push(boost::iostreams::lzma_decompressor());
+          break;
+        default:
+          break;
+      }
+      // Standard input cannot be rewound, so the bytes that were inspected are
+      // served first.
+      m_filter->push(PrefixedSource(std::string(magic, n), *raw));
+      m_stream = m_filter.get();
+      return *m_stream;
+    }
+    Compression
+    compression() const
+    {
+      return m_compression;
+    }
+  private:
+    /// @brief Boost.Iostreams source that yields a prefix before the rest of a stream.
+    struct PrefixedSource
+    {
+      typedef char char_type;
+      typedef boost::iostreams::source_tag category;
+      PrefixedSource(const std::string& prefix, std::istream& rest) :
+        prefix(prefix), pos(0), rest(&rest)
+      {
+      }
+      std::streamsize
+      read(char* s, std::streamsize n)
+      {
+        std::streamsize result = 0;
+        while (pos < prefix.size() and result < n)
+          s[result++] = prefix[pos++];
+        if (result < n)
+        {
+          rest->read(s + result, n - result);
+          result += rest->gcount();
+        }
+        return result > 0 ? result : -1;
+      }
+      std::string prefix;
+      size_t pos;
+      std::istream* rest;
+    };
+
+    Compression m_compression;
+    std::istream* m_stream;
+    std::unique_ptr<std::ifstream> m_file;
+    std::unique_ptr<boost::iostreams::filtering_istream> m_filter;
+};
+
+/**
+ * @class OutputFile
+ * @brief Opens a file or standard output for writing.
+ *
+ * Output to a file whose name ends in .gz, .zst or .xz is compressed
+ * accordingly. Compressed output is completed when the OutputFile is
+ * destroyed.
+ */
+class OutputFile
+{
+  public:
+    OutputFile() : m_compression(uncompressed), m_stream(NULL) {}
+    /**
+     * @brief Opens @a filename, or standard output if @a filename is empty.
+     * @return The stream to which the (uncompressed) contents can be written.
+     */
+    std::ostream&
+    open(const std::string& filename)
+    {
+      m_stream = &std::cout;
+      if (filename.empty())
+        return *m_stream;
+      m_file.reset(new std::ofstream(filename.c_str(), std::ios::out | std::ios::binary));
+      if (!*m_file)
+        throw std::runtime_error("Could not open " + filename + ".");
+      m_stream = m_file.get();
+      m_compression = compression_by_extension(filename);
+      if (m_compression == uncompressed)
+        return *m_stream;
+      m_filter.reset(new boost::iostreams::filtering_ostream());
+      switch (m_compression)
+      {
+        case gzip:
+          m_filter->push(boost::iostreams::gzip_compressor());
+          break;
+        case zstd:
+          m_filter->push(boost::iostreams::zstd_compressor());
+          break;
+        case xz:
+          m_filter->push(boost::iostreams::lzma_compressor());
+          break;
+        default:
+          break;
+      }
+      m_filter->push(*m_file);
+      m_stream = m_filter.get();
+      return *m_stream;
+    }
+    Compression
+    compression() const
+    {
+      return m_compression;
+    }
+  private:
+    Compression m_compression;
+    std::ostream* m_stream;
+    std::unique_ptr<std::ofstream> m_file; // Destroyed after m_filter, which writes to it.
+    std::unique_ptr<boost::iostreams::filtering_ostream> m_filter;
+};
+
+#endif // __STREAMS_H